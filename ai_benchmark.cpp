@@ -0,0 +1,423 @@
+#include "ai_player.h"
+#include "alloc_counter.h"
+#include "board_status.h"
+#include "game_core.h"
+#include "game_record.h"
+#include "game_search.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Times the AI hot paths over a fixed corpus of positions and prints one row per
+// benchmark, as a table or as JSON/CSV for diffing runs between commits.
+//
+// Usage: ai_benchmark [--format table|json|csv] [--min-time MS] [--filter TEXT] [--threads N]
+
+struct BenchResult {
+    std::string name;
+    uint64_t calls = 0;
+    double seconds = 0.0;
+    uint64_t nodes = 0;             // Units of work done, counted in unit
+    uint64_t allocations = 0;
+    const char* unit = "node";
+    
+    double NsPerCall() const { return calls ? seconds * 1e9 / calls : 0.0; }
+    double NodesPerCall() const { return calls ? (double)nodes / calls : 0.0; }
+    double NsPerNode() const { return nodes ? seconds * 1e9 / nodes : 0.0; }
+    double AllocationsPerCall() const { return calls ? (double)allocations / calls : 0.0; }
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Every reachable 3x3 position with moves left, in key order so runs are comparable
+static std::vector<Bitboard> BuildCorpus() {
+    std::vector<bool> visited(POSITION_KEYS, false);
+    std::vector<Bitboard> pending = {Bitboard{}};
+    std::vector<Bitboard> corpus;
+    
+    while (!pending.empty()) {
+        Bitboard board = pending.back();
+        pending.pop_back();
+        
+        if (visited[board.Key()]) {
+            continue;
+        }
+        visited[board.Key()] = true;
+        
+        Mark toMove = board.ToMove();
+        if (board.HasWon(Opponent(toMove)) || board.IsFull()) {
+            continue;
+        }
+        corpus.push_back(board);
+        
+        for (uint16_t empty = board.EmptyCells(); empty; empty &= empty - 1) {
+            pending.push_back(board.Play(LowestCell(empty), toMove));
+        }
+    }
+    
+    std::sort(corpus.begin(), corpus.end(), [](const Bitboard& a, const Bitboard& b) { return a.Key() < b.Key(); });
+    return corpus;
+}
+
+// Calls call(i) for i = 0, 1, ... in passes of passSize until minSeconds have elapsed.
+// call returns the nodes it visited; the clock is read once per pass.
+template <typename Call>
+static BenchResult Measure(const std::string& name, size_t passSize, double minSeconds, Call call) {
+    BenchResult result;
+    result.name = name;
+    
+    uint64_t allocationsBefore = AllocationCount();
+    Clock::time_point start = Clock::now();
+    do {
+        for (size_t i = 0; i < passSize; i++) {
+            result.nodes += call(i);
+        }
+        result.calls += passSize;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (result.seconds < minSeconds);
+    
+    result.allocations = AllocationCount() - allocationsBefore;
+    return result;
+}
+
+// As Measure, but runs prepare(i) untimed before every call, e.g. to empty a cache
+template <typename Prepare, typename Call>
+static BenchResult MeasureCold(const std::string& name, size_t passSize, double minSeconds, 
+                               Prepare prepare, Call call) {
+    BenchResult result;
+    result.name = name;
+    
+    Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(minSeconds));
+    do {
+        for (size_t i = 0; i < passSize; i++) {
+            prepare(i);
+            
+            uint64_t allocationsBefore = AllocationCount();
+            Clock::time_point start = Clock::now();
+            result.nodes += call(i);
+            result.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            result.allocations += AllocationCount() - allocationsBefore;
+        }
+        result.calls += passSize;
+    } while (Clock::now() < end);
+    
+    return result;
+}
+
+// A new header starts each run of rows counting a different unit of work
+static void PrintTable(const std::vector<BenchResult>& results) {
+    const char* unit = nullptr;
+    for (const BenchResult& r : results) {
+        if (!unit || std::strcmp(unit, r.unit) != 0) {
+            unit = r.unit;
+            std::string perCall = std::string(unit) + "s/call";
+            std::string perUnit = std::string("ns/") + unit;
+            std::printf("%-28s %12s %12s %14s %10s %12s\n", "benchmark", "calls", "ns/call", perCall.c_str(), 
+                        perUnit.c_str(), "allocs/call");
+        }
+        std::printf("%-28s %12llu %12.1f %14.1f %10.2f %12.3f\n", r.name.c_str(), (unsigned long long)r.calls, 
+                    r.NsPerCall(), r.NodesPerCall(), r.NsPerNode(), r.AllocationsPerCall());
+    }
+}
+
+static void PrintJson(const std::vector<BenchResult>& results) {
+    std::printf("{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        std::printf("    {\"name\": \"%s\", \"calls\": %llu, \"ns_per_call\": %.3f, \"%ss_per_call\": %.3f, ", 
+                    r.name.c_str(), (unsigned long long)r.calls, r.NsPerCall(), r.unit, r.NodesPerCall());
+        if (r.nodes) {
+            std::printf("\"ns_per_%s\": %.3f, ", r.unit, r.NsPerNode());
+        } else {
+            std::printf("\"ns_per_%s\": null, ", r.unit);
+        }
+        std::printf("\"allocs_per_call\": %.4f}%s\n", r.AllocationsPerCall(), (i + 1 < results.size()) ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+
+static void PrintCsv(const std::vector<BenchResult>& results) {
+    std::printf("name,calls,ns_per_call,work_per_call,ns_per_work,allocs_per_call,unit\n");
+    for (const BenchResult& r : results) {
+        std::printf("%s,%llu,%.3f,%.3f,", r.name.c_str(), (unsigned long long)r.calls, r.NsPerCall(), r.NodesPerCall());
+        if (r.nodes) {
+            std::printf("%.3f", r.NsPerNode());
+        }
+        std::printf(",%.4f,%s\n", r.AllocationsPerCall(), r.unit);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* format = "table";
+    double minSeconds = 0.2;
+    const char* filter = "";
+    int threads = (int)std::thread::hardware_concurrency();
+    
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            format = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]) / 1000.0;
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(std::atoi(argv[++i]), 1);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--format table|json|csv] [--min-time MS] [--filter TEXT] [--threads N]\n", 
+                         argv[0]);
+            return 1;
+        }
+    }
+    
+    if (std::strcmp(format, "table") != 0 && std::strcmp(format, "json") != 0 && std::strcmp(format, "csv") != 0) {
+        std::fprintf(stderr, "Unknown format: %s\n", format);
+        return 1;
+    }
+    
+    const std::vector<Bitboard> corpus = BuildCorpus();
+    std::vector<BenchResult> results;
+    auto selected = [filter](const char* name) { return std::strstr(name, filter) != nullptr; };
+    
+    // A fixed seed keeps the random moves of Easy and Normal identical between runs
+    AIPlayer ai;
+    ai.SetSeed(12345);
+    
+    const char* levelNames[] = {"get_best_move/easy", "get_best_move/normal", "get_best_move/hard"};
+    const AIPlayer::Difficulty levels[] = {
+        AIPlayer::Difficulty::Easy, AIPlayer::Difficulty::Normal, AIPlayer::Difficulty::Hard
+    };
+    for (int level = 0; level < 3; level++) {
+        if (!selected(levelNames[level])) {
+            continue;
+        }
+        results.push_back(Measure(levelNames[level], corpus.size(), minSeconds, [&](size_t i) {
+            uint64_t before = ai.NodesSearched();
+            ai.GetBestMove(corpus[i], corpus[i].ToMove(), levels[level]);
+            return ai.NodesSearched() - before;
+        }));
+    }
+    
+    // Full Minimax from an empty transposition table, then with every position cached
+    if (selected("minimax/cold")) {
+        results.push_back(MeasureCold("minimax/cold", corpus.size(), minSeconds, 
+            [&](size_t) { ai.ClearSearchCache(); }, 
+            [&](size_t i) {
+                uint64_t before = ai.NodesSearched();
+                ai.GetSearchedMove(corpus[i], corpus[i].ToMove());
+                return ai.NodesSearched() - before;
+            }));
+    }
+    
+    if (selected("minimax/warm")) {
+        results.push_back(Measure("minimax/warm", corpus.size(), minSeconds, [&](size_t i) {
+            uint64_t before = ai.NodesSearched();
+            ai.GetSearchedMove(corpus[i], corpus[i].ToMove());
+            return ai.NodesSearched() - before;
+        }));
+    }
+    
+    // Win check and heuristic evaluation, the per-node costs of every search
+    volatile int sink = 0;
+    if (selected("has_won")) {
+        results.push_back(Measure("has_won", corpus.size(), minSeconds, [&](size_t i) {
+            sink = sink + corpus[i].HasWon(Mark::X) + corpus[i].HasWon(Mark::O);
+            return uint64_t(0);
+        }));
+    }
+    
+    // Win/draw status of every 3x3 board, one at a time and with the batch kernel, per board
+    std::vector<Bitboard> allBoards(POSITION_KEYS);
+    for (int key = 0; key < POSITION_KEYS; key++) {
+        for (int cell = 0, rest = key; cell < BOARD_CELLS; cell++, rest /= 3) {
+            if (rest % 3 != 0) {
+                allBoards[key].Place(cell, (rest % 3 == 1) ? Mark::X : Mark::O);
+            }
+        }
+    }
+    std::vector<BoardStatus> statuses(allBoards.size());
+    
+    if (selected("board_status/scalar")) {
+        BenchResult result = Measure("board_status/scalar", 1, minSeconds, [&](size_t) {
+            GetBoardStatusBatchScalar(allBoards.data(), allBoards.size(), statuses.data());
+            return uint64_t(0);
+        });
+        result.calls *= allBoards.size();
+        results.push_back(result);
+    }
+    
+    std::string batchName = std::string("board_status/") + BoardStatusKernel();
+    if (batchName != "board_status/scalar" && selected(batchName.c_str())) {
+        BenchResult result = Measure(batchName, 1, minSeconds, [&](size_t) {
+            GetBoardStatusBatch(allBoards.data(), allBoards.size(), statuses.data());
+            return uint64_t(0);
+        });
+        result.calls *= allBoards.size();
+        results.push_back(result);
+    }
+    
+    if (selected("evaluate_position/3x3")) {
+        results.push_back(Measure("evaluate_position/3x3", corpus.size(), minSeconds, [&](size_t i) {
+            sink = sink + EvaluatePosition(corpus[i], corpus[i].ToMove());
+            return uint64_t(0);
+        }));
+    }
+    
+    // Fixed-depth generic search from the empty 7x7 board with a fresh table
+    if (selected("grid_search/7x7k4_d4")) {
+        TranspositionTable table(20);
+        SearchLimits limits;
+        limits.maxDepth = 4;
+        results.push_back(MeasureCold("grid_search/7x7k4_d4", 1, minSeconds, 
+            [&](size_t) { table.Clear(); }, 
+            [&](size_t) { return GameSearch<GridBoard<7, 4>>(table).Search(GridBoard<7, 4>(), limits).nodes; }));
+    }
+    
+    // MonteCarlo moves at a fixed playout count from an empty tree, since a kept tree would
+    // already hold the visits; nodes are playouts here, so ns/node is ns/playout
+    AIPlayer mctsAi;
+    mctsAi.SetSeed(12345);
+    mctsAi.SetPlayoutBudget(10000);
+    
+    // One pool serves every board type; it is allocated by the first search, not measured
+    mctsAi.GetBestMove(Bitboard(), Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    auto measureMcts = [&](const char* name, auto board) {
+        if (selected(name)) {
+            results.push_back(MeasureCold(name, 1, minSeconds, [&](size_t) { mctsAi.NewGame(); }, [&](size_t) {
+                uint64_t before = mctsAi.NodesSearched();
+                mctsAi.GetBestMove(board, board.ToMove(), AIPlayer::Difficulty::MonteCarlo);
+                return mctsAi.NodesSearched() - before;
+            }));
+        }
+    };
+    measureMcts("mcts/3x3", Bitboard());
+    measureMcts("mcts/7x7k4", GridBoard<7, 4>());
+    measureMcts("mcts/15x15k5", GridBoard<15, 5>());
+    
+    // Batch evaluation, reported per position: the whole corpus on the thread pool, and
+    // every one-stone 5x5 opening searched to depth 4 against looping over the positions
+    AIPlayer batchAi;
+    batchAi.SetThreadCount(threads);
+    std::vector<int> cells(corpus.size());
+    std::vector<int> scores(corpus.size());
+    
+    if (selected("evaluate_batch/3x3")) {
+        BenchResult result = Measure("evaluate_batch/3x3", 1, minSeconds, [&](size_t) {
+            batchAi.EvaluateBatch(corpus.data(), corpus.size(), cells.data(), scores.data());
+            return uint64_t(0);
+        });
+        result.calls *= corpus.size();
+        results.push_back(result);
+    }
+    
+    std::array<GridBoard<5, 4>, 25> openings = {};
+    for (int cell = 0; cell < 25; cell++) {
+        openings[cell].Place(cell, Mark::X);
+    }
+    
+    if (selected("evaluate_batch/5x5k4_d4")) {
+        BenchResult result = MeasureCold("evaluate_batch/5x5k4_d4", 1, minSeconds, 
+            [&](size_t) { batchAi.ClearSearchCache(); }, 
+            [&](size_t) {
+                uint64_t before = batchAi.NodesSearched();
+                batchAi.EvaluateBatch(openings.data(), openings.size(), cells.data(), scores.data(), 4);
+                return batchAi.NodesSearched() - before;
+            });
+        result.calls *= openings.size();
+        results.push_back(result);
+    }
+    
+    if (selected("search_loop/5x5k4_d4")) {
+        TranspositionTable table(20);
+        SearchLimits limits;
+        limits.maxDepth = 4;
+        BenchResult result = MeasureCold("search_loop/5x5k4_d4", 1, minSeconds, 
+            [&](size_t) { table.Clear(); }, 
+            [&](size_t) {
+                uint64_t nodes = 0;
+                for (const GridBoard<5, 4>& board : openings) {
+                    nodes += GameSearch<GridBoard<5, 4>>(table).Search(board, limits).nodes;
+                }
+                return nodes;
+            });
+        result.calls *= openings.size();
+        results.push_back(result);
+    }
+    
+    // Game records, reported per game: 100k random 3x3 games written through one buffer
+    // and the writer thread to the system temp directory, then read back counting moves
+    if (selected("game_record/write_3x3") || selected("game_record/read_3x3")) {
+        std::string path = (std::filesystem::temp_directory_path() / "ai_benchmark_games.tmp").string();
+        std::vector<GameRecord> games(100000);
+        uint64_t random = 42;
+        for (GameRecord& record : games) {
+            GameCore game;
+            game.Start(PlayerType::AI, PlayerType::AI);
+            while (!game.IsOver()) {
+                int cell = (int)(SplitMix64(random) % BOARD_CELLS);
+                game.Play(cell / 3, cell % 3);
+            }
+            game.Record(record);
+        }
+        uint64_t totalMoves = 0;
+        for (const GameRecord& record : games) {
+            totalMoves += record.moveCount;
+        }
+        
+        auto writeGames = [&]() {
+            GameRecordWriter writer;
+            writer.Open(path, 3, 3);
+            {
+                GameRecordBuffer buffer(writer);
+                for (const GameRecord& record : games) {
+                    buffer.Append(record);
+                }
+            }
+            writer.Close();
+        };
+        writeGames();
+        
+        if (selected("game_record/write_3x3")) {
+            BenchResult result = Measure("game_record/write_3x3", 1, minSeconds, [&](size_t) {
+                writeGames();
+                return totalMoves;
+            });
+            result.calls *= games.size();
+            result.unit = "move";
+            results.push_back(result);
+        }
+        
+        if (selected("game_record/read_3x3")) {
+            BenchResult result = Measure("game_record/read_3x3", 1, minSeconds, [&](size_t) {
+                GameRecordReader reader;
+                reader.Open(path);
+                uint64_t moves = 0;
+                while (const GameRecord* record = reader.Next()) {
+                    moves += record->moveCount;
+                }
+                return moves;
+            });
+            result.calls *= games.size();
+            result.unit = "move";
+            results.push_back(result);
+        }
+        std::remove(path.c_str());
+    }
+    
+    if (std::strcmp(format, "json") == 0) {
+        PrintJson(results);
+    } else if (std::strcmp(format, "csv") == 0) {
+        PrintCsv(results);
+    } else {
+        PrintTable(results);
+    }
+    
+    return 0;
+}
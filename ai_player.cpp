@@ -1,10 +1,27 @@
 #include "ai_player.h"
+#include "perfect_play.h"
 #include <algorithm>
+#include <vector>
 
-AIPlayer::AIPlayer() : m_rng(m_rd()) {
+// Enough slots for every canonical position, AI side and side to move without collisions
+static constexpr int TABLE_SIZE_LOG2 = 17;
+
+// 1M entries (16 MB) for the generic N x N search
+static constexpr int GRID_TABLE_SIZE_LOG2 = 20;
+
+// Default per-move search budget on larger boards
+static constexpr std::chrono::milliseconds DEFAULT_TIME_BUDGET{500};
+
+// Default MonteCarlo tree ceiling: 1M nodes, 16 MB
+static constexpr size_t DEFAULT_MCTS_NODE_LIMIT = 1 << 20;
+
+AIPlayer::AIPlayer() : m_rng(m_rd()), m_table(TABLE_SIZE_LOG2), m_timeBudget(DEFAULT_TIME_BUDGET), m_threads(1), 
+                       m_mctsNodeLimit(DEFAULT_MCTS_NODE_LIMIT) {
 }
 
-std::pair<int, int> AIPlayer::GetBestMove(const std::array<std::array<CellState, 3>, 3>& board, CellState aiPlayer, Difficulty difficulty) {
+std::pair<int, int> AIPlayer::GetBestMove(const Bitboard& board, Mark aiPlayer, Difficulty difficulty) {
+    m_lastStats.Clear();
+    
     // Choose the move based on difficulty level
     switch (difficulty) {
         case Difficulty::Easy:
@@ -13,96 +30,187 @@ std::pair<int, int> AIPlayer::GetBestMove(const std::array<std::array<CellState,
         case Difficulty::Normal:
             return GetIntermediateMove(board, aiPlayer);
             
+        case Difficulty::MonteCarlo:
+            return GetMctsMove(board, aiPlayer);
+            
         case Difficulty::Hard:
         default:
-            // Hard difficulty - use full minimax algorithm
-            CellState humanPlayer = (aiPlayer == CellState::X) ? CellState::O : CellState::X;
-            
-            int bestScore = -1000;
-            std::pair<int, int> bestMove = {-1, -1};
-            
-            // Check for available moves and evaluate each one
-            for (int i = 0; i < 3; i++) {
-                for (int j = 0; j < 3; j++) {
-                    if (board[i][j] == CellState::Empty) {
-                        // Try this move
-                        auto boardCopy = board;
-                        boardCopy[i][j] = aiPlayer;
-                        
-                        // Calculate score for this move using minimax
-                        int score = Minimax(boardCopy, 0, false, aiPlayer, humanPlayer, -1000, 1000);
-                        
-                        // If this move has a better score than our best move so far, update bestMove
-                        if (score > bestScore) {
-                            bestScore = score;
-                            bestMove = {i, j};
-                        }
-                    }
-                }
-            }
-            
-            return bestMove;
+            return GetOptimalMove(board, aiPlayer);
     }
 }
 
-std::pair<int, int> AIPlayer::GetRandomMove(const std::array<std::array<CellState, 3>, 3>& board) {
-    // Count empty cells
-    std::vector<std::pair<int, int>> emptyCells;
+void AIPlayer::GetBestMoveAsync(const Bitboard& board, Mark aiPlayer, Difficulty difficulty, MoveCallback onDone) {
+    m_async.Start([this, board, aiPlayer, difficulty](const std::atomic<bool>& cancelled) {
+        m_cancelFlag = &cancelled;
+        std::pair<int, int> move = GetBestMove(board, aiPlayer, difficulty);
+        m_cancelFlag = nullptr;
+        return move;
+    }, std::move(onDone));
+}
+
+void AIPlayer::CancelSearch() {
+    m_async.Cancel();
+}
+
+std::pair<int, int> AIPlayer::GetOptimalMove(const Bitboard& board, Mark aiPlayer) {
+    // The table is solved for the side to move; other requests fall through to the search
+    if (aiPlayer == board.ToMove()) {
+        const PerfectPlayEntry& entry = LookupPerfectPlay(board);
+        if (entry.cell >= 0) {
+            m_lastStats.source = SearchStats::Source::PerfectPlay;
+            return {entry.cell / 3, entry.cell % 3};
+        }
+    }
+    
+    int bestScore;
+    return SearchOptimalMove(board, aiPlayer, bestScore);
+}
+
+std::pair<int, int> AIPlayer::SearchOptimalMove(const Bitboard& board, Mark aiPlayer, int& bestScore) {
+    Mark humanPlayer = Opponent(aiPlayer);
+    
+    bestScore = -1000;
+    std::pair<int, int> bestMove = {-1, -1};
+    m_lastStats.source = SearchStats::Source::Search;
+    
+    // The clock is only read when asked for; it would cost as much as a warm search
+    std::chrono::steady_clock::time_point moveStart;
+    if (m_timeSearches) {
+        moveStart = std::chrono::steady_clock::now();
+    }
     
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            if (board[i][j] == CellState::Empty) {
-                emptyCells.push_back({i, j});
+    // Evaluate each empty cell in row-major order
+    for (uint16_t empty = board.EmptyCells(); empty; empty &= empty - 1) {
+        int cell = LowestCell(empty);
+        uint64_t nodesBefore = m_lastStats.nodes;
+        
+        // Calculate score for this move using minimax
+        int score = Minimax(board.Play(cell, aiPlayer), 0, false, aiPlayer, humanPlayer, -1000, 1000);
+        SEARCH_TRACE(m_traceSink, RootMove, 0, cell, score);
+        
+        if (RootMoveStats* rootMove = m_lastStats.AddRootMove(cell)) {
+            rootMove->score = score;
+            rootMove->nodes = m_lastStats.nodes - nodesBefore;
+            if (m_timeSearches) {
+                std::chrono::steady_clock::time_point moveEnd = std::chrono::steady_clock::now();
+                rootMove->seconds = std::chrono::duration<double>(moveEnd - moveStart).count();
+                m_lastStats.seconds += rootMove->seconds;
+                moveStart = moveEnd;
             }
         }
+        
+        // If this move has a better score than our best move so far, update bestMove
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = {cell / 3, cell % 3};
+        }
+    }
+    
+    return bestMove;
+}
+
+void AIPlayer::EvaluateBatch(const Bitboard* boards, size_t count, int* cells, int* scores) {
+    // Every 3x3 position is in the perfect-play table, so each one is a single lookup
+    Pool().ParallelFor(count, [boards, cells, scores](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const PerfectPlayEntry& entry = LookupPerfectPlay(boards[i]);
+            cells[i] = entry.cell;
+            scores[i] = entry.value;
+        }
+    });
+}
+
+std::pair<int, int> AIPlayer::GetSearchedMove(const Bitboard& board, Mark aiPlayer, int* score) {
+    m_lastStats.Clear();
+    int bestScore;
+    std::pair<int, int> move = SearchOptimalMove(board, aiPlayer, bestScore);
+    if (score) {
+        *score = bestScore;
+    }
+    return move;
+}
+
+void AIPlayer::NewGame() {
+    if (m_mctsTree) {
+        m_mctsTree->Clear();
+    }
+    if (m_gridTable) {
+        m_gridTable->Clear();
+    }
+}
+
+void AIPlayer::ClearSearchCache() {
+    m_table.Clear();
+    NewGame();
+}
+
+int AIPlayer::VerifyPerfectPlayTable() {
+    // Start from an empty transposition table so every answer comes from a fresh search
+    m_table.Clear();
+    
+    std::vector<bool> visited(POSITION_KEYS, false);
+    std::vector<Bitboard> pending = {Bitboard{}};
+    int mismatches = 0;
+    
+    while (!pending.empty()) {
+        Bitboard board = pending.back();
+        pending.pop_back();
+        
+        if (visited[board.Key()]) {
+            continue;
+        }
+        visited[board.Key()] = true;
+        
+        Mark toMove = board.ToMove();
+        if (board.HasWon(Opponent(toMove)) || board.IsFull()) {
+            continue;
+        }
+        
+        int score;
+        m_lastStats.Clear();
+        std::pair<int, int> move = SearchOptimalMove(board, toMove, score);
+        const PerfectPlayEntry& entry = LookupPerfectPlay(board);
+        if (entry.cell != move.first * 3 + move.second || entry.value != score) {
+            mismatches++;
+        }
+        
+        for (uint16_t empty = board.EmptyCells(); empty; empty &= empty - 1) {
+            pending.push_back(board.Play(LowestCell(empty), toMove));
+        }
     }
     
+    return mismatches;
+}
+
+std::pair<int, int> AIPlayer::GetRandomMove(const Bitboard& board) {
+    // Count empty cells
+    uint16_t empty = board.EmptyCells();
+    int emptyCount = PopCount(empty);
+    
     // If no empty cells, return invalid move
-    if (emptyCells.empty()) {
+    if (emptyCount == 0) {
         return {-1, -1};
     }
+    m_lastStats.source = SearchStats::Source::Random;
     
-    // Pick a random empty cell
-    std::uniform_int_distribution<int> dist(0, emptyCells.size() - 1);
-    int randomIndex = dist(m_rng);
+    // Pick a random empty cell by dropping that many lower empty cells from the mask
+    std::uniform_int_distribution<int> dist(0, emptyCount - 1);
+    for (int skip = dist(m_rng); skip > 0; skip--) {
+        empty &= empty - 1;
+    }
     
-    return emptyCells[randomIndex];
+    int cell = LowestCell(empty);
+    return {cell / 3, cell % 3};
 }
 
-std::pair<int, int> AIPlayer::GetIntermediateMove(const std::array<std::array<CellState, 3>, 3>& board, CellState aiPlayer) {
+std::pair<int, int> AIPlayer::GetIntermediateMove(const Bitboard& board, Mark aiPlayer) {
     // 60% of the time, make an optimal move
     // 40% of the time, make a random move
     std::uniform_real_distribution<double> dist(0.0, 1.0);
     double randomVal = dist(m_rng);
     
     if (randomVal < 0.6) {
-        // Make an optimal move
-        CellState humanPlayer = (aiPlayer == CellState::X) ? CellState::O : CellState::X;
-        
-        int bestScore = -1000;
-        std::pair<int, int> bestMove = {-1, -1};
-        
-        // Try each possible move
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                if (board[i][j] == CellState::Empty) {
-                    // Try this move
-                    auto boardCopy = board;
-                    boardCopy[i][j] = aiPlayer;
-                    
-                    // Calculate score for this move using minimax
-                    int score = Minimax(boardCopy, 0, false, aiPlayer, humanPlayer, -1000, 1000);
-                    
-                    // If this move has a better score than our best move so far, update bestMove
-                    if (score > bestScore) {
-                        bestScore = score;
-                        bestMove = {i, j};
-                    }
-                }
-            }
-        }
-        
-        return bestMove;
+        return GetOptimalMove(board, aiPlayer);
     } 
     else {
         // Make a random move
@@ -110,33 +218,73 @@ std::pair<int, int> AIPlayer::GetIntermediateMove(const std::array<std::array<Ce
     }
 }
 
-int AIPlayer::Minimax(std::array<std::array<CellState, 3>, 3> board, int depth, bool isMaximizing, 
-                      CellState aiPlayer, CellState humanPlayer, int alpha, int beta) {
+int AIPlayer::Minimax(Bitboard board, int depth, bool isMaximizing, 
+                      Mark aiPlayer, Mark humanPlayer, int alpha, int beta) {
+    m_nodes++;
+    m_lastStats.nodes++;
+    m_lastStats.maxDepth = std::max(m_lastStats.maxDepth, depth + 1);
+    SEARCH_TRACE(m_traceSink, Node, depth + 1, -1, 0);
+    
     // Check terminal states
     int score = EvaluateBoard(board, aiPlayer, humanPlayer);
     
     // If we have a winner or board is full, return the score
-    if (score == 10 || score == -10 || IsBoardFull(board)) {
+    if (score != 0 || board.IsFull()) {
+        m_lastStats.leafEvaluations++;
+        SEARCH_TRACE(m_traceSink, Leaf, depth + 1, -1, score);
         return score;
     }
     
+    // Reuse what we know about this position or any of its rotations/mirrors
+    uint64_t key = TableKey(board, aiPlayer, isMaximizing);
+    TTEntry entry;
+    m_lastStats.tableProbes++;
+    if (m_table.Probe(key, entry)) {
+        m_lastStats.tableHits++;
+        SEARCH_TRACE(m_traceSink, TableHit, depth + 1, -1, entry.score);
+        if (entry.bound == Bound::Exact) {
+            return entry.score;
+        } else if (entry.bound == Bound::Lower) {
+            alpha = std::max(alpha, (int)entry.score);
+        } else if (entry.bound == Bound::Upper) {
+            beta = std::min(beta, (int)entry.score);
+        }
+        
+        if (beta <= alpha) {
+            return entry.score;
+        }
+    }
+    
+    int bestScore = Search(board, depth, isMaximizing, aiPlayer, humanPlayer, alpha, beta);
+    
+    // A score outside the window is only a bound on the true value
+    Bound bound = Bound::Exact;
+    if (bestScore <= alpha) {
+        bound = Bound::Upper;
+    } else if (bestScore >= beta) {
+        bound = Bound::Lower;
+    }
+    m_table.Store(key, bestScore, bound);
+    
+    return bestScore;
+}
+
+int AIPlayer::Search(Bitboard board, int depth, bool isMaximizing, 
+                     Mark aiPlayer, Mark humanPlayer, int alpha, int beta) {
     // AI's turn (maximizing player)
     if (isMaximizing) {
         int bestScore = -1000;
         
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                if (board[i][j] == CellState::Empty) {
-                    board[i][j] = aiPlayer;
-                    bestScore = std::max(bestScore, Minimax(board, depth + 1, false, aiPlayer, humanPlayer, alpha, beta));
-                    board[i][j] = CellState::Empty;
-                    
-                    // Alpha-beta pruning
-                    alpha = std::max(alpha, bestScore);
-                    if (beta <= alpha) {
-                        break;
-                    }
-                }
+        for (uint16_t empty = board.EmptyCells(); empty; empty &= empty - 1) {
+            int cell = LowestCell(empty);
+            bestScore = std::max(bestScore, Minimax(board.Play(cell, aiPlayer), depth + 1, false, aiPlayer, humanPlayer, alpha, beta));
+            
+            // Alpha-beta pruning
+            alpha = std::max(alpha, bestScore);
+            if (beta <= alpha) {
+                m_lastStats.cutoffs++;
+                SEARCH_TRACE(m_traceSink, Cutoff, depth + 1, cell, bestScore);
+                break;
             }
         }
         
@@ -146,19 +294,16 @@ int AIPlayer::Minimax(std::array<std::array<CellState, 3>, 3> board, int depth,
     else {
         int bestScore = 1000;
         
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                if (board[i][j] == CellState::Empty) {
-                    board[i][j] = humanPlayer;
-                    bestScore = std::min(bestScore, Minimax(board, depth + 1, true, aiPlayer, humanPlayer, alpha, beta));
-                    board[i][j] = CellState::Empty;
-                    
-                    // Alpha-beta pruning
-                    beta = std::min(beta, bestScore);
-                    if (beta <= alpha) {
-                        break;
-                    }
-                }
+        for (uint16_t empty = board.EmptyCells(); empty; empty &= empty - 1) {
+            int cell = LowestCell(empty);
+            bestScore = std::min(bestScore, Minimax(board.Play(cell, humanPlayer), depth + 1, true, aiPlayer, humanPlayer, alpha, beta));
+            
+            // Alpha-beta pruning
+            beta = std::min(beta, bestScore);
+            if (beta <= alpha) {
+                m_lastStats.cutoffs++;
+                SEARCH_TRACE(m_traceSink, Cutoff, depth + 1, cell, bestScore);
+                break;
             }
         }
         
@@ -166,52 +311,36 @@ int AIPlayer::Minimax(std::array<std::array<CellState, 3>, 3> board, int depth,
     }
 }
 
-bool AIPlayer::CheckWin(const std::array<std::array<CellState, 3>, 3>& board, CellState player) {
-    // Check rows
-    for (int i = 0; i < 3; i++) {
-        if (board[i][0] == player && board[i][1] == player && board[i][2] == player) {
-            return true;
-        }
-    }
-    
-    // Check columns
-    for (int i = 0; i < 3; i++) {
-        if (board[0][i] == player && board[1][i] == player && board[2][i] == player) {
-            return true;
-        }
+TranspositionTable& AIPlayer::GridTable() {
+    if (!m_gridTable) {
+        m_gridTable = std::make_unique<TranspositionTable>(GRID_TABLE_SIZE_LOG2);
     }
-    
-    // Check diagonals
-    if (board[0][0] == player && board[1][1] == player && board[2][2] == player) {
-        return true;
-    }
-    
-    if (board[0][2] == player && board[1][1] == player && board[2][0] == player) {
-        return true;
-    }
-    
-    return false;
+    return *m_gridTable;
 }
 
-bool AIPlayer::IsBoardFull(const std::array<std::array<CellState, 3>, 3>& board) {
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            if (board[i][j] == CellState::Empty) {
-                return false;
-            }
-        }
+ThreadPool& AIPlayer::Pool() {
+    if (!m_pool || m_pool->Size() != m_threads) {
+        m_pool = std::make_unique<ThreadPool>(m_threads);
     }
-    return true;
+    return *m_pool;
+}
+
+uint64_t AIPlayer::TableKey(const Bitboard& board, Mark aiPlayer, bool isMaximizing) {
+    uint64_t key = board.CanonicalKey();
+    return (key << 2) | ((aiPlayer == Mark::O) ? 2 : 0) | (isMaximizing ? 1 : 0);
 }
 
-int AIPlayer::EvaluateBoard(const std::array<std::array<CellState, 3>, 3>& board, CellState aiPlayer, CellState humanPlayer) {
-    if (CheckWin(board, aiPlayer)) {
-        return 10;
+int AIPlayer::EvaluateBoard(const Bitboard& board, Mark aiPlayer, Mark humanPlayer) {
+    // Empty cells left at the end make quicker wins and slower losses score better
+    int remaining = BOARD_CELLS - board.MoveCount();
+    
+    if (board.HasWon(aiPlayer)) {
+        return 10 + remaining;
     }
     
-    if (CheckWin(board, humanPlayer)) {
-        return -10;
+    if (board.HasWon(humanPlayer)) {
+        return -10 - remaining;
     }
     
     return 0; // No winner, game ongoing or draw
-} 
\ No newline at end of file
+}
@@ -1,8 +1,23 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <utility>
 #include <random>
+#include <string>
+#include "async_search.h"
+#include "bitboard.h"
+#include "game_search.h"
+#include "grid_board.h"
+#include "mcts_search.h"
+#include "opening_book.h"
+#include "search_stats.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
 
 // Forward declaration
 class XOGame;
@@ -12,54 +27,328 @@ public:
     AIPlayer();
 
     enum class CellState { Empty, X, O };
-    enum class Difficulty { Easy, Normal, Hard };
+    // MonteCarlo runs a Monte Carlo tree search within the playout or time budget; meant for larger boards
+    enum class Difficulty { Easy, Normal, Hard, MonteCarlo };
     
     // Calculate the best move for the AI based on difficulty
-    std::pair<int, int> GetBestMove(const std::array<std::array<CellState, 3>, 3>& board, CellState aiPlayer, Difficulty difficulty = Difficulty::Hard);
+    std::pair<int, int> GetBestMove(const Bitboard& board, Mark aiPlayer, Difficulty difficulty = Difficulty::Hard);
     
-    // Overload for XOGame's CellState enum
+    // Overload for any 3x3 array board with Empty/X/O cell states (XOGame::CellState, AIPlayer::CellState)
     template <typename T>
     std::pair<int, int> GetBestMove(const std::array<std::array<T, 3>, 3>& board, T aiPlayer, Difficulty difficulty = Difficulty::Hard) {
-        // Convert board from XOGame::CellState to AIPlayer::CellState
-        std::array<std::array<CellState, 3>, 3> convertedBoard;
+        return GetBestMove(PackBoard(board), (aiPlayer == T::X) ? Mark::X : Mark::O, difficulty);
+    }
+    
+    using MoveCallback = std::function<void(std::pair<int, int> move)>;
+    
+    // Runs GetBestMove on a background thread and calls onDone with the move from that thread.
+    // A search already running is cancelled first. Do not call other AIPlayer methods while
+    // a search runs; the worker owns the search state until it finishes or is cancelled.
+    void GetBestMoveAsync(const Bitboard& board, Mark aiPlayer, Difficulty difficulty, MoveCallback onDone);
+    
+    template <typename T>
+    void GetBestMoveAsync(const std::array<std::array<T, 3>, 3>& board, T aiPlayer, Difficulty difficulty, MoveCallback onDone) {
+        GetBestMoveAsync(PackBoard(board), (aiPlayer == T::X) ? Mark::X : Mark::O, difficulty, std::move(onDone));
+    }
+    
+    template <int N, int K>
+    void GetBestMoveAsync(const GridBoard<N, K>& board, Mark aiPlayer, Difficulty difficulty, MoveCallback onDone) {
+        m_async.Start([this, board, aiPlayer, difficulty](const std::atomic<bool>& cancelled) {
+            m_cancelFlag = &cancelled;
+            std::pair<int, int> move = GetBestMove(board, aiPlayer, difficulty);
+            m_cancelFlag = nullptr;
+            return move;
+        }, std::move(onDone));
+    }
+    
+    // Stops a running background search and waits for it; its callback will not be called
+    void CancelSearch();
+    
+    // Pack a 3x3 array board into one bitmask per side
+    template <typename T>
+    static Bitboard PackBoard(const std::array<std::array<T, 3>, 3>& board) {
+        Bitboard packed;
         for (int i = 0; i < 3; i++) {
             for (int j = 0; j < 3; j++) {
-                if (board[i][j] == T::Empty) 
-                    convertedBoard[i][j] = CellState::Empty;
-                else if (board[i][j] == T::X) 
-                    convertedBoard[i][j] = CellState::X;
-                else 
-                    convertedBoard[i][j] = CellState::O;
+                if (board[i][j] == T::X) 
+                    packed.x |= 1u << (i * 3 + j);
+                else if (board[i][j] == T::O) 
+                    packed.o |= 1u << (i * 3 + j);
             }
         }
+        return packed;
+    }
+
+    // Reseeds the random choices of Easy and Normal, for reproducible games
+    void SetSeed(uint32_t seed) { m_rng.seed(seed); }
+    
+    // Wall-clock limit for one Hard move on larger boards; the best move found so far is played when it expires
+    void SetTimeBudget(std::chrono::milliseconds budget) { m_timeBudget = budget; }
+    
+    // Forgets what earlier moves of the game left behind for later ones: the MonteCarlo tree
+    // and the larger-board transposition table. The 3x3 Minimax table holds exact values
+    // valid in any game and is kept. Call when a new game starts.
+    void NewGame();
+    
+    // Depth limit in plies for Hard on larger boards; 0 (the default) searches until the time budget runs out
+    void SetSearchDepth(int plies) { m_searchDepth = std::max(plies, 0); }
+    
+    // Root visits per MonteCarlo move, counting those kept from the previous move's tree;
+    // 0 (the default) plays within the time budget instead
+    void SetPlayoutBudget(uint64_t playouts) { m_playoutBudget = playouts; }
+    
+    // Ceiling on the MonteCarlo tree, in nodes of sizeof(MctsNode) bytes (default 1M, 16 MB)
+    void SetMctsNodeLimit(size_t nodes) { m_mctsNodeLimit = std::max<size_t>(nodes, 1); }
+    
+    // Playouts, tree size and time of the last MonteCarlo move
+    const MctsResult& LastMctsResult() const { return m_lastMcts; }
+    
+    // How the last GetBestMove or GetSearchedMove chose its move, with the counters of any
+    // search behind it and each root move's score and nodes; MonteCarlo counts its playouts
+    // as nodes. Read it after the call returns, or from an async call's callback.
+    const SearchStats& LastSearchStats() const { return m_lastStats; }
+    
+    // Also time the search and each of its root moves in LastSearchStats. Off by default:
+    // a 3x3 search from a warm table takes only a few times as long as the clock reads.
+    void SetSearchTiming(bool enabled) { m_timeSearches = enabled; }
+    
+    // Receives every position of later searches, on the thread running them, in builds
+    // with XO_SEARCH_TRACE (see search_stats.h); other builds never call it. nullptr stops.
+    void SetTraceSink(SearchTraceSink* sink) { m_traceSink = sink; }
+    
+    // Bytes the MonteCarlo tree's pool holds now, at its peak and at most, for bounding
+    // memory per worker; zero before the first MonteCarlo move
+    ArenaStats SearchMemory() const { return m_mctsTree ? m_mctsTree->MemoryStats() : ArenaStats(); }
+    
+    // Maps a book made by book_gen; Hard and Normal play its move for any position it holds
+    // on the board size it was built for, and search the rest. False if the file is
+    // missing or malformed, leaving no book loaded.
+    bool LoadBook(const std::string& path) { return m_book.Open(path); }
+    
+    const OpeningBook& Book() const { return m_book; }
+    
+    // Threads used by Hard searches on larger boards (3x3 is a table lookup)
+    void SetThreadCount(int threads) { m_threads = std::max(threads, 1); }
+    
+    // Larger boards (e.g. 7x7 four in a row) run the generic engine; 3x3 uses the Bitboard overload above
+    template <int N, int K>
+    std::pair<int, int> GetBestMove(const GridBoard<N, K>& board, Mark aiPlayer, Difficulty difficulty = Difficulty::Hard) {
+        m_lastStats.Clear();
+        switch (difficulty) {
+            case Difficulty::Easy:
+                return GetRandomGridMove(board);
+                
+            case Difficulty::Normal: {
+                // Same 60/40 split between optimal and random moves as 3x3
+                std::uniform_real_distribution<double> dist(0.0, 1.0);
+                if (dist(m_rng) >= 0.6) {
+                    return GetRandomGridMove(board);
+                }
+                return GetOptimalGridMove(board, aiPlayer);
+            }
+                
+            case Difficulty::MonteCarlo:
+                return GetMctsMove(board, aiPlayer);
+                
+            case Difficulty::Hard:
+            default:
+                return GetOptimalGridMove(board, aiPlayer);
+        }
+    }
+    
+    // Best move and value for the side to move in each of count positions, spread over
+    // SetThreadCount threads. cells[i] receives row * 3 + col (-1 once the game is over),
+    // scores[i] the perfect-play value (10 + empty cells left for a win, negated for a loss).
+    void EvaluateBatch(const Bitboard* boards, size_t count, int* cells, int* scores);
+    
+    // Larger boards: each position gets its own search (up to maxDepth plies, 0 for no
+    // limit, and the time budget), all threads sharing one transposition table.
+    // cells[i] receives row * N + col, scores[i] the search score for the side to move.
+    template <int N, int K>
+    void EvaluateBatch(const GridBoard<N, K>* boards, size_t count, int* cells, int* scores, int maxDepth = 0) {
+        SearchLimits limits;
+        limits.maxDepth = maxDepth;
+        limits.budget = m_timeBudget;
+        limits.cancel = m_cancelFlag;
         
-        // Convert aiPlayer from XOGame::CellState to AIPlayer::CellState
-        CellState convertedAiPlayer = (aiPlayer == T::X) ? CellState::X : CellState::O;
-        
-        // Call the original GetBestMove with converted parameters
-        return GetBestMove(convertedBoard, convertedAiPlayer, difficulty);
+        TranspositionTable& table = GridTable();
+        std::atomic<uint64_t> nodes{0};
+        Pool().ParallelFor(count, [&](size_t begin, size_t end) {
+            GameSearch<GridBoard<N, K>> search(table);
+            uint64_t chunkNodes = 0;
+            for (size_t i = begin; i < end; i++) {
+                SearchResult result = search.Search(boards[i], limits);
+                cells[i] = result.cell;
+                scores[i] = result.score;
+                chunkNodes += result.nodes;
+            }
+            nodes += chunkNodes;
+        });
+        m_nodes += nodes;
     }
+    
+    // Hard move by live Minimax search, bypassing the perfect-play table (benchmarks, self-checks,
+    // regression replays); score, if given, receives Minimax's score for the move
+    std::pair<int, int> GetSearchedMove(const Bitboard& board, Mark aiPlayer, int* score = nullptr);
+    
+    // Drops cached search results so the next search starts cold
+    void ClearSearchCache();
+    
+    // Positions visited by Minimax and the larger-board search, plus MonteCarlo playouts, since construction
+    uint64_t NodesSearched() const { return m_nodes; }
+    
+    // Self-check: compares the compiled-in perfect-play table against a live Minimax search
+    // of every reachable position. Returns the number of positions where they disagree.
+    int VerifyPerfectPlayTable();
 
 private:
-    // Minimax algorithm with alpha-beta pruning
-    int Minimax(std::array<std::array<CellState, 3>, 3> board, int depth, bool isMaximizing, 
-                CellState aiPlayer, CellState humanPlayer, int alpha, int beta);
+    // Minimax algorithm with alpha-beta pruning and transposition table lookups
+    int Minimax(Bitboard board, int depth, bool isMaximizing, 
+                Mark aiPlayer, Mark humanPlayer, int alpha, int beta);
+    
+    // Expands every move of a non-terminal position for Minimax
+    int Search(Bitboard board, int depth, bool isMaximizing, 
+               Mark aiPlayer, Mark humanPlayer, int alpha, int beta);
+    
+    // Hard difficulty - best move from the perfect-play table, searching only if the table does not apply
+    std::pair<int, int> GetOptimalMove(const Bitboard& board, Mark aiPlayer);
+    
+    // Best move by full minimax search; bestScore receives its score
+    std::pair<int, int> SearchOptimalMove(const Bitboard& board, Mark aiPlayer, int& bestScore);
     
     // Easy difficulty - make random valid moves
-    std::pair<int, int> GetRandomMove(const std::array<std::array<CellState, 3>, 3>& board);
+    std::pair<int, int> GetRandomMove(const Bitboard& board);
 
     // Normal difficulty - sometimes make good moves, sometimes random
-    std::pair<int, int> GetIntermediateMove(const std::array<std::array<CellState, 3>, 3>& board, CellState aiPlayer);
+    std::pair<int, int> GetIntermediateMove(const Bitboard& board, Mark aiPlayer);
+    
+    // Evaluate the board for minimax (returns +10 for AI win, -10 for player win, 0 for draw or ongoing),
+    // with the number of empty cells added to a win's margin so faster wins are preferred
+    int EvaluateBoard(const Bitboard& board, Mark aiPlayer, Mark humanPlayer);
+    
+    template <int N, int K>
+    std::pair<int, int> GetOptimalGridMove(const GridBoard<N, K>& board, Mark aiPlayer) {
+        if (aiPlayer != board.ToMove()) {
+            return {-1, -1};
+        }
+        
+        if (m_book.Covers(N, K)) {
+            const BookRecord* record = m_book.Find(board.Hash());
+            if (record && record->cell >= 0 && record->cell < N * N && board.IsEmpty(record->cell)) {
+                m_lastStats.source = SearchStats::Source::Book;
+                return {record->cell / N, record->cell % N};
+            }
+        }
+        
+        SearchLimits limits;
+        limits.maxDepth = m_searchDepth;
+        limits.budget = m_timeBudget;
+        limits.cancel = m_cancelFlag;
+        limits.threads = m_threads;
+        limits.stats = &m_lastStats;
+        limits.timeRootMoves = m_timeSearches;
+        limits.trace = m_traceSink;
+        
+        m_lastStats.source = SearchStats::Source::Search;
+        std::chrono::steady_clock::time_point start;
+        if (m_timeSearches) {
+            start = std::chrono::steady_clock::now();
+        }
+        SearchResult result = GameSearch<GridBoard<N, K>>(GridTable()).Search(board, limits);
+        m_nodes += result.nodes;
+        if (m_timeSearches) {
+            m_lastStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        
+        int cell = result.cell;
+        return (cell < 0) ? std::pair<int, int>{-1, -1} : std::pair<int, int>{cell / N, cell % N};
+    }
+    
+    // MonteCarlo difficulty on any board type; 3x3 boards come here too
+    template <typename Board>
+    std::pair<int, int> GetMctsMove(const Board& board, Mark aiPlayer) {
+        if (aiPlayer != board.ToMove()) {
+            return {-1, -1};
+        }
+        
+        MctsLimits limits;
+        limits.playouts = m_playoutBudget;
+        limits.budget = (m_playoutBudget > 0) ? std::chrono::milliseconds(0) : m_timeBudget;
+        limits.cancel = m_cancelFlag;
+        
+        // The tree is kept between moves, in one pool whatever the board type; only a new
+        // node limit allocates another
+        if (!m_mctsTree || m_mctsTree->NodeLimit() != m_mctsNodeLimit) {
+            m_mctsTree = std::make_unique<MctsTree>(m_mctsNodeLimit);
+        }
+        
+        MctsSearch<Board> search(*m_mctsTree);
+        m_lastMcts = search.Search(board, limits, m_rng());
+        m_nodes += m_lastMcts.playouts;
+        m_lastStats.source = SearchStats::Source::MonteCarlo;
+        m_lastStats.nodes = m_lastMcts.playouts;
+        m_lastStats.seconds = m_lastMcts.seconds;
+        
+        int cell = m_lastMcts.cell;
+        return (cell < 0) ? std::pair<int, int>{-1, -1} : std::pair<int, int>{cell / Board::SIZE, cell % Board::SIZE};
+    }
+    
+    template <int N, int K>
+    std::pair<int, int> GetRandomGridMove(const GridBoard<N, K>& board) {
+        int emptyCount = GridBoard<N, K>::CELLS - board.MoveCount();
+        if (emptyCount == 0) {
+            return {-1, -1};
+        }
+        m_lastStats.source = SearchStats::Source::Random;
+        
+        // Walk to the chosen empty cell
+        std::uniform_int_distribution<int> dist(0, emptyCount - 1);
+        int cell = board.NextEmpty(0);
+        for (int skip = dist(m_rng); skip > 0; skip--) {
+            cell = board.NextEmpty(cell + 1);
+        }
+        return {cell / N, cell % N};
+    }
     
-    // Check if someone has won
-    bool CheckWin(const std::array<std::array<CellState, 3>, 3>& board, CellState player);
+    // Shared by all larger board sizes; Zobrist keys differ per size, so entries do not mix
+    TranspositionTable& GridTable();
     
-    // Check if the board is full
-    bool IsBoardFull(const std::array<std::array<CellState, 3>, 3>& board);
+    // Batch workers, (re)created on first use with the current thread count
+    ThreadPool& Pool();
     
-    // Evaluate the board for minimax (returns +10 for AI win, -10 for player win, 0 for draw or ongoing)
-    int EvaluateBoard(const std::array<std::array<CellState, 3>, 3>& board, CellState aiPlayer, CellState humanPlayer);
+    // Table key for a position: symmetry-canonical board plus the searching side and side to move
+    static uint64_t TableKey(const Bitboard& board, Mark aiPlayer, bool isMaximizing);
     
     std::random_device m_rd;
     std::mt19937 m_rng;
-}; 
\ No newline at end of file
+    
+    // Minimax results, kept across calls; scores do not depend on search depth
+    TranspositionTable m_table;
+    
+    // Allocated on first use so 3x3-only games do not pay for it
+    std::unique_ptr<TranspositionTable> m_gridTable;
+    std::unique_ptr<ThreadPool> m_pool;
+    
+    // Precomputed moves for larger boards, empty unless LoadBook succeeded
+    OpeningBook m_book;
+    
+    // MonteCarlo tree of the current game, kept between moves
+    std::unique_ptr<MctsTree> m_mctsTree;
+    
+    std::chrono::milliseconds m_timeBudget;
+    int m_threads;
+    int m_searchDepth = 0;
+    uint64_t m_nodes = 0;
+    uint64_t m_playoutBudget = 0;
+    size_t m_mctsNodeLimit;
+    MctsResult m_lastMcts;
+    SearchStats m_lastStats;
+    bool m_timeSearches = false;
+    SearchTraceSink* m_traceSink = nullptr;
+    
+    // Set while a search runs on the async worker, so long searches stop when cancelled
+    const std::atomic<bool>* m_cancelFlag = nullptr;
+    
+    // Declared last so the worker is joined before the state it uses is destroyed
+    AsyncSearch m_async;
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// Linking alloc_counter.cpp into a console tool replaces the global operator new
+// and delete with versions that count every heap allocation in the process.
+// Kept out of the core library so the game and the GUI use the standard ones.
+
+// Allocations made so far; compare two readings to count the ones in between
+uint64_t AllocationCount();
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Usage of one or more arenas, in bytes
+struct ArenaStats {
+    size_t used = 0;
+    size_t peak = 0;        // Most ever in use since the arena was created or ResetPeak was called
+    size_t capacity = 0;
+
+    ArenaStats& operator+=(const ArenaStats& other) {
+        used += other.used;
+        peak += other.peak;
+        capacity += other.capacity;
+        return *this;
+    }
+};
+
+// Bump allocator over one block reserved up front. Nothing is freed on its own:
+// Reset drops everything (per move or per game) and Rewind everything past a given
+// length (NodePool keeping the front of its nodes), so allocating is a pointer bump
+// and the memory a worker can use has a fixed ceiling. Holds only trivially destructible types, since
+// their destructors never run.
+class Arena {
+public:
+    explicit Arena(size_t bytes)
+        : m_block(new std::max_align_t[(bytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]),
+          m_capacity(bytes) {}
+
+    // count value-initialized T, or nullptr if the arena cannot hold them
+    template <typename T>
+    T* Allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is released without destructors");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+        size_t offset = (m_used + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (offset > m_capacity || count > (m_capacity - offset) / sizeof(T)) {
+            return nullptr;
+        }
+
+        T* items = reinterpret_cast<T*>(Data() + offset);
+        for (size_t i = 0; i < count; i++) {
+            new (items + i) T();
+        }
+        m_used = offset + count * sizeof(T);
+        m_peak = std::max(m_peak, m_used);
+        return items;
+    }
+
+    // Keeps the first bytes in use and releases the rest
+    void Rewind(size_t bytes) { m_used = std::min(bytes, m_used); }
+
+    void Reset() { m_used = 0; }
+    void ResetPeak() { m_peak = m_used; }
+
+    uint8_t* Data() { return reinterpret_cast<uint8_t*>(m_block.get()); }
+    const uint8_t* Data() const { return reinterpret_cast<const uint8_t*>(m_block.get()); }
+
+    size_t Used() const { return m_used; }
+    size_t Capacity() const { return m_capacity; }
+    ArenaStats Stats() const { return ArenaStats{m_used, m_peak, m_capacity}; }
+
+private:
+    std::unique_ptr<std::max_align_t[]> m_block;
+    size_t m_capacity;
+    size_t m_used = 0;
+    size_t m_peak = 0;
+};
@@ -0,0 +1,37 @@
+#include "async_search.h"
+
+AsyncSearch::~AsyncSearch() {
+    Cancel();
+}
+
+void AsyncSearch::Start(Work work, Callback onDone) {
+    Cancel();
+    
+    m_cancelled = false;
+    m_running = true;
+    m_worker = std::thread([this, work = std::move(work), onDone = std::move(onDone)]() {
+        std::pair<int, int> move = work(m_cancelled);
+        
+        // Cancel() takes the same lock, so a callback never starts after it returns
+        {
+            std::lock_guard<std::mutex> lock(m_deliverMutex);
+            if (!m_cancelled) {
+                onDone(move);
+            }
+        }
+        
+        m_running = false;
+    });
+}
+
+void AsyncSearch::Cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_deliverMutex);
+        m_cancelled = true;
+    }
+    
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    m_running = false;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Runs one move search at a time on a background thread. Portable: the caller
+// decides how the result reaches its own thread (XOGame posts a window message).
+class AsyncSearch {
+public:
+    using Work = std::function<std::pair<int, int>(const std::atomic<bool>& cancelled)>;
+    using Callback = std::function<void(std::pair<int, int> move)>;
+    
+    AsyncSearch() = default;
+    ~AsyncSearch();
+    
+    AsyncSearch(const AsyncSearch&) = delete;
+    AsyncSearch& operator=(const AsyncSearch&) = delete;
+    
+    // Cancels any running search, then runs work on a new thread and passes its result
+    // to onDone from that thread. work should poll cancelled and return early when set.
+    void Start(Work work, Callback onDone);
+    
+    // Stops the running search and waits for its thread. Once this returns, the
+    // cancelled search's callback has either already finished or will never run.
+    void Cancel();
+    
+    bool IsRunning() const { return m_running; }
+
+private:
+    std::thread m_worker;
+    std::mutex m_deliverMutex;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<bool> m_running{false};
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Cells are numbered row-major: bit (row * 3 + col) of a side's mask
+constexpr int BOARD_CELLS = 9;
+constexpr uint16_t FULL_BOARD = 0x1FF;
+
+// The eight winning lines as cell masks
+constexpr std::array<uint16_t, 8> WIN_LINES = {
+    0x007, 0x038, 0x1C0,    // Rows
+    0x049, 0x092, 0x124,    // Columns
+    0x111, 0x054            // Diagonals
+};
+
+// Lookup of every 9-bit mask that contains at least one winning line
+constexpr std::array<bool, 512> MakeWinTable() {
+    std::array<bool, 512> table = {};
+    for (int mask = 0; mask < 512; mask++) {
+        for (uint16_t line : WIN_LINES) {
+            if ((mask & line) == line) {
+                table[mask] = true;
+                break;
+            }
+        }
+    }
+    return table;
+}
+
+constexpr std::array<bool, 512> WIN_TABLE = MakeWinTable();
+
+constexpr int PopCount(uint16_t mask) {
+#ifdef __GNUC__
+    return __builtin_popcount(mask);
+#else
+    int count = 0;
+    for (; mask; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Index of the lowest set bit; mask must be non-zero
+constexpr int LowestCell(uint16_t mask) {
+#ifdef __GNUC__
+    return __builtin_ctz(mask);
+#else
+    int cell = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        cell++;
+    }
+    return cell;
+#endif
+}
+
+// Cell permutations for the 8 symmetries of the square: 4 rotations, then their mirror images
+constexpr std::array<std::array<int, 9>, 8> SYMMETRIES = {{
+    {0, 1, 2, 3, 4, 5, 6, 7, 8},    // Identity
+    {6, 3, 0, 7, 4, 1, 8, 5, 2},    // Rotate 90
+    {8, 7, 6, 5, 4, 3, 2, 1, 0},    // Rotate 180
+    {2, 5, 8, 1, 4, 7, 0, 3, 6},    // Rotate 270
+    {2, 1, 0, 5, 4, 3, 8, 7, 6},    // Mirror left-right
+    {0, 3, 6, 1, 4, 7, 2, 5, 8},    // Transpose
+    {6, 7, 8, 3, 4, 5, 0, 1, 2},    // Mirror top-bottom
+    {8, 5, 2, 7, 4, 1, 6, 3, 0}     // Anti-transpose
+}};
+
+// Every 9-bit mask pushed through every symmetry; SYMMETRIES[s][i] is the cell that lands on cell i
+constexpr std::array<std::array<uint16_t, 512>, 8> MakeSymmetryTable() {
+    std::array<std::array<uint16_t, 512>, 8> table = {};
+    for (int s = 0; s < 8; s++) {
+        for (int mask = 0; mask < 512; mask++) {
+            uint16_t mapped = 0;
+            for (int cell = 0; cell < 9; cell++) {
+                if (mask & (1 << SYMMETRIES[s][cell])) {
+                    mapped |= 1u << cell;
+                }
+            }
+            table[s][mask] = mapped;
+        }
+    }
+    return table;
+}
+
+constexpr std::array<std::array<uint16_t, 512>, 8> SYMMETRY_TABLE = MakeSymmetryTable();
+
+// Sum of 3^cell over the bits of a mask, for base-3 position keys
+constexpr std::array<uint16_t, 512> MakeBase3Table() {
+    std::array<uint16_t, 512> table = {};
+    for (int mask = 0; mask < 512; mask++) {
+        uint16_t value = 0;
+        uint16_t power = 1;
+        for (int cell = 0; cell < 9; cell++) {
+            if (mask & (1 << cell)) {
+                value += power;
+            }
+            power *= 3;
+        }
+        table[mask] = value;
+    }
+    return table;
+}
+
+constexpr std::array<uint16_t, 512> BASE3_TABLE = MakeBase3Table();
+
+// Number of distinct base-3 keys (3^9)
+constexpr int POSITION_KEYS = 19683;
+
+enum class Mark : uint8_t { X, O };
+
+constexpr Mark Opponent(Mark mark) {
+    return mark == Mark::X ? Mark::O : Mark::X;
+}
+
+// A 3x3 position held as one bitmask per side
+struct Bitboard {
+    static constexpr int SIZE = 3;
+    static constexpr int WIN_LENGTH = 3;
+    static constexpr int CELLS = BOARD_CELLS;
+
+    uint16_t x = 0;
+    uint16_t o = 0;
+
+    constexpr uint16_t Mask(Mark mark) const { return mark == Mark::X ? x : o; }
+    constexpr uint16_t Occupied() const { return x | o; }
+    constexpr uint16_t EmptyCells() const { return ~(x | o) & FULL_BOARD; }
+
+    constexpr bool IsEmpty(int cell) const { return !(Occupied() & (1u << cell)); }
+    constexpr bool Has(int cell, Mark mark) const { return Mask(mark) & (1u << cell); }
+    constexpr bool HasWon(Mark mark) const { return WIN_TABLE[Mask(mark)]; }
+    constexpr bool IsFull() const { return Occupied() == FULL_BOARD; }
+    constexpr int MoveCount() const { return PopCount(Occupied()); }
+
+    // Side to move, assuming X always starts
+    constexpr Mark ToMove() const { return PopCount(x) > PopCount(o) ? Mark::O : Mark::X; }
+
+    // Base-3 encoding: digit per cell, 0 empty, 1 X, 2 O
+    constexpr uint32_t Key() const { return BASE3_TABLE[x] + 2u * BASE3_TABLE[o]; }
+
+    constexpr Bitboard Transform(int symmetry) const {
+        return Bitboard{SYMMETRY_TABLE[symmetry][x], SYMMETRY_TABLE[symmetry][o]};
+    }
+
+    // Smallest key over the 8 symmetric images, shared by rotated and mirrored positions
+    constexpr uint32_t CanonicalKey() const {
+        uint32_t best = Key();
+        for (int s = 1; s < 8; s++) {
+            uint32_t key = Transform(s).Key();
+            if (key < best) {
+                best = key;
+            }
+        }
+        return best;
+    }
+
+    // Hash shared with GridBoard's interface; symmetric positions hash alike
+    constexpr uint64_t Hash() const { return CanonicalKey(); }
+
+    // First empty cell at or after from, or -1
+    constexpr int NextEmpty(int from) const {
+        uint16_t empty = (uint16_t)(EmptyCells() >> from << from);
+        return empty ? LowestCell(empty) : -1;
+    }
+
+    constexpr void Place(int cell, Mark mark) {
+        if (mark == Mark::X) {
+            x |= 1u << cell;
+        } else {
+            o |= 1u << cell;
+        }
+    }
+
+    constexpr void Undo(int cell, Mark mark) {
+        if (mark == Mark::X) {
+            x &= ~(1u << cell);
+        } else {
+            o &= ~(1u << cell);
+        }
+    }
+
+    // Returns a copy with the given mark placed on cell
+    constexpr Bitboard Play(int cell, Mark mark) const {
+        Bitboard next = *this;
+        next.Place(cell, mark);
+        return next;
+    }
+
+    constexpr bool operator==(const Bitboard& other) const { return x == other.x && o == other.o; }
+    constexpr bool operator!=(const Bitboard& other) const { return !(*this == other); }
+};
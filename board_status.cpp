@@ -0,0 +1,134 @@
+#include "board_status.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define BOARD_STATUS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define BOARD_STATUS_SSE2
+#endif
+
+// Each Bitboard is 32 bits, x in the low half and o in the high half, so a vector of
+// boards is a vector of 16-bit masks that every line test handles side by side
+static_assert(sizeof(Bitboard) == 4 && offsetof(Bitboard, x) == 0 && offsetof(Bitboard, o) == 2, 
+              "boards must pack as x | o << 16");
+
+void GetBoardStatusBatchScalar(const Bitboard* boards, size_t count, BoardStatus* status) {
+    for (size_t i = 0; i < count; i++) {
+        status[i] = GetBoardStatus(boards[i]);
+    }
+}
+
+#if defined(BOARD_STATUS_AVX2)
+
+void GetBoardStatusBatch(const Bitboard* boards, size_t count, BoardStatus* status) {
+    const __m256i full = _mm256_set1_epi32(FULL_BOARD);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    const __m256i three = _mm256_set1_epi32(3);
+    
+    const __m256i rowStarts = _mm256_set1_epi16(0x049);
+    const __m256i colStarts = _mm256_set1_epi16(0x007);
+    const __m256i diagonal = _mm256_set1_epi16(0x111);
+    const __m256i antiDiagonal = _mm256_set1_epi16(0x054);
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(boards + i));
+        
+        // A row is complete where a cell and the next two to its right are all set, a column
+        // where a cell and the two below it are; the two diagonals are compared whole.
+        // All-ones 16-bit lanes where that side's mask holds a line.
+        __m256i rows = _mm256_and_si256(_mm256_and_si256(v, _mm256_srli_epi16(v, 1)), _mm256_srli_epi16(v, 2));
+        __m256i cols = _mm256_and_si256(_mm256_and_si256(v, _mm256_srli_epi16(v, 3)), _mm256_srli_epi16(v, 6));
+        __m256i lines = _mm256_or_si256(_mm256_and_si256(rows, rowStarts), _mm256_and_si256(cols, colStarts));
+        __m256i won = _mm256_or_si256(
+            _mm256_cmpeq_epi16(_mm256_and_si256(v, diagonal), diagonal),
+            _mm256_cmpeq_epi16(_mm256_and_si256(v, antiDiagonal), antiDiagonal));
+        won = _mm256_or_si256(won, _mm256_xor_si256(_mm256_cmpeq_epi16(lines, _mm256_setzero_si256()), _mm256_set1_epi32(-1)));
+        
+        // Per board: 1 if X won, 2 if only O won, 3 if nobody won on a full board
+        __m256i xWon = _mm256_srli_epi32(_mm256_slli_epi32(won, 16), 16);
+        __m256i oWon = _mm256_srli_epi32(won, 16);
+        __m256i occupied = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 16)), full);
+        __m256i isFull = _mm256_cmpeq_epi32(occupied, full);
+        __m256i code = _mm256_and_si256(xWon, one);
+        code = _mm256_or_si256(code, _mm256_andnot_si256(xWon, _mm256_and_si256(oWon, two)));
+        code = _mm256_or_si256(code, _mm256_andnot_si256(_mm256_or_si256(xWon, oWon), _mm256_and_si256(isFull, three)));
+        
+        // Narrow the eight 32-bit codes to bytes; packs works within 128-bit halves
+        __m128i low = _mm256_castsi256_si128(code);
+        __m128i high = _mm256_extracti128_si256(code, 1);
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(low, high), _mm_setzero_si128());
+        _mm_storel_epi64((__m128i*)(status + i), bytes);
+    }
+    
+    GetBoardStatusBatchScalar(boards + i, count - i, status + i);
+}
+
+const char* BoardStatusKernel() {
+    return "avx2";
+}
+
+#elif defined(BOARD_STATUS_SSE2)
+
+void GetBoardStatusBatch(const Bitboard* boards, size_t count, BoardStatus* status) {
+    const __m128i full = _mm_set1_epi32(FULL_BOARD);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    const __m128i three = _mm_set1_epi32(3);
+    
+    const __m128i rowStarts = _mm_set1_epi16(0x049);
+    const __m128i colStarts = _mm_set1_epi16(0x007);
+    const __m128i diagonal = _mm_set1_epi16(0x111);
+    const __m128i antiDiagonal = _mm_set1_epi16(0x054);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(boards + i));
+        
+        // A row is complete where a cell and the next two to its right are all set, a column
+        // where a cell and the two below it are; the two diagonals are compared whole.
+        // All-ones 16-bit lanes where that side's mask holds a line.
+        __m128i rows = _mm_and_si128(_mm_and_si128(v, _mm_srli_epi16(v, 1)), _mm_srli_epi16(v, 2));
+        __m128i cols = _mm_and_si128(_mm_and_si128(v, _mm_srli_epi16(v, 3)), _mm_srli_epi16(v, 6));
+        __m128i lines = _mm_or_si128(_mm_and_si128(rows, rowStarts), _mm_and_si128(cols, colStarts));
+        __m128i won = _mm_or_si128(
+            _mm_cmpeq_epi16(_mm_and_si128(v, diagonal), diagonal),
+            _mm_cmpeq_epi16(_mm_and_si128(v, antiDiagonal), antiDiagonal));
+        won = _mm_or_si128(won, _mm_xor_si128(_mm_cmpeq_epi16(lines, _mm_setzero_si128()), _mm_set1_epi32(-1)));
+        
+        // Per board: 1 if X won, 2 if only O won, 3 if nobody won on a full board
+        __m128i xWon = _mm_srli_epi32(_mm_slli_epi32(won, 16), 16);
+        __m128i oWon = _mm_srli_epi32(won, 16);
+        __m128i occupied = _mm_and_si128(_mm_or_si128(v, _mm_srli_epi32(v, 16)), full);
+        __m128i isFull = _mm_cmpeq_epi32(occupied, full);
+        __m128i code = _mm_and_si128(xWon, one);
+        code = _mm_or_si128(code, _mm_andnot_si128(xWon, _mm_and_si128(oWon, two)));
+        code = _mm_or_si128(code, _mm_andnot_si128(_mm_or_si128(xWon, oWon), _mm_and_si128(isFull, three)));
+        
+        // Narrow the four 32-bit codes to bytes
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(code, code), code);
+        int packed = _mm_cvtsi128_si32(bytes);
+        std::memcpy(status + i, &packed, 4);
+    }
+    
+    GetBoardStatusBatchScalar(boards + i, count - i, status + i);
+}
+
+const char* BoardStatusKernel() {
+    return "sse2";
+}
+
+#else
+
+void GetBoardStatusBatch(const Bitboard* boards, size_t count, BoardStatus* status) {
+    GetBoardStatusBatchScalar(boards, count, status);
+}
+
+const char* BoardStatusKernel() {
+    return "scalar";
+}
+
+#endif
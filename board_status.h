@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "bitboard.h"
+
+enum class BoardStatus : uint8_t { Playing, XWon, OWon, Draw };
+
+// Status of one board, one win-table lookup per side; X is checked first
+inline BoardStatus GetBoardStatus(const Bitboard& board) {
+    if (board.HasWon(Mark::X)) {
+        return BoardStatus::XWon;
+    }
+    if (board.HasWon(Mark::O)) {
+        return BoardStatus::OWon;
+    }
+    return board.IsFull() ? BoardStatus::Draw : BoardStatus::Playing;
+}
+
+// Win/draw status of count boards at once. Uses AVX2 (8 boards per step) or SSE2
+// (4 per step) when the compiler targets them, e.g. make ARCH_FLAGS=-mavx2 or
+// MSVC /arch:AVX2, and the scalar loop below otherwise and for the tail.
+void GetBoardStatusBatch(const Bitboard* boards, size_t count, BoardStatus* status);
+
+// The one-board-at-a-time loop, kept for comparison and as the fallback
+void GetBoardStatusBatchScalar(const Bitboard* boards, size_t count, BoardStatus* status);
+
+// Name of the kernel GetBoardStatusBatch was compiled with: "avx2", "sse2" or "scalar"
+const char* BoardStatusKernel();
@@ -0,0 +1,188 @@
+#include "game_search.h"
+#include "grid_board.h"
+#include "opening_book.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Builds an opening book for AIPlayer::LoadBook. Every position with up to P stones
+// that is reachable from the empty board (transpositions stored once) is searched
+// to D plies, or to the end of the game with --depth 0, on T threads sharing one
+// transposition table.
+//
+// Usage: book_gen [--board 4x4k3|4x4k4|5x5k4|6x6k4|7x7k4|15x15k5] [--plies P] [--depth D]
+//                 [--budget MS] [--threads T] OUTPUT
+//   --budget caps each position's search; positions cut short are stored with the depth
+//   they completed and are not marked exact.
+//   P and D default per board (see BOARD_DEFAULTS). Boards larger than 4x4 are never
+//   solved in practice, so there --depth 0 needs a --budget.
+
+struct BookOptions {
+    int plies = -1;         // -1 takes the board's default
+    int depth = -1;
+    int budgetMs = 0;
+    int threads = 1;
+    std::string path;
+};
+
+// Plies and depth for each board when not given: 4x4 boards are solved outright, the
+// larger ones take about a minute or less on one core
+struct BoardDefaults {
+    const char* name;
+    int plies;
+    int depth;
+};
+
+static constexpr BoardDefaults BOARD_DEFAULTS[] = {
+    {"4x4k3", 4, 0},
+    {"4x4k4", 4, 0},
+    {"5x5k4", 2, 6},
+    {"6x6k4", 2, 4},
+    {"7x7k4", 1, 4},
+    {"15x15k5", 1, 2},
+};
+
+// 2^22 entries (64 MB), enough for the deeper searches of small boards
+static constexpr int BOOK_TABLE_SIZE_LOG2 = 22;
+
+template <int N, int K>
+static bool BuildBook(const BookOptions& options) {
+    using Board = GridBoard<N, K>;
+    auto start = std::chrono::steady_clock::now();
+
+    if (N > 4 && options.depth == 0 && options.budgetMs == 0) {
+        std::fprintf(stderr, "--depth 0 on %dx%d needs a --budget, or the search would not finish\n", N, N);
+        return false;
+    }
+
+    // Ply by ply from the empty board; finished games have no move to store
+    std::vector<Board> positions = {Board()};
+    std::unordered_set<uint64_t> seen = {Board().Hash()};
+    size_t levelBegin = 0;
+    for (int ply = 0; ply < options.plies; ply++) {
+        size_t levelEnd = positions.size();
+        for (size_t i = levelBegin; i < levelEnd; i++) {
+            Mark toMove = positions[i].ToMove();
+            for (int cell = positions[i].NextEmpty(0); cell >= 0; cell = positions[i].NextEmpty(cell + 1)) {
+                Board next = positions[i];
+                next.Place(cell, toMove);
+                if (!next.HasWon(toMove) && !next.IsFull() && seen.insert(next.Hash()).second) {
+                    positions.push_back(next);
+                }
+            }
+        }
+        levelBegin = levelEnd;
+    }
+
+    SearchLimits limits;
+    limits.maxDepth = options.depth;
+    limits.budget = std::chrono::milliseconds(options.budgetMs);
+
+    TranspositionTable table(BOOK_TABLE_SIZE_LOG2);
+    ThreadPool pool(options.threads);
+    std::vector<BookEntry> entries(positions.size());
+    pool.ParallelFor(positions.size(), [&](size_t begin, size_t end) {
+        GameSearch<Board> search(table);
+        for (size_t i = begin; i < end; i++) {
+            SearchResult result = search.Search(positions[i], limits);
+            entries[i].hash = positions[i].Hash();
+            entries[i].record.cell = (int16_t)result.cell;
+            entries[i].record.score = (int16_t)result.score;
+            entries[i].record.depth = (uint8_t)std::min(result.depth, 255);
+            entries[i].record.exact = result.complete ? 1 : 0;
+        }
+    });
+
+    size_t exact = 0;
+    for (const BookEntry& entry : entries) {
+        exact += entry.record.exact;
+    }
+
+    if (!WriteOpeningBook(options.path, N, K, entries)) {
+        std::fprintf(stderr, "Cannot write %s\n", options.path.c_str());
+        return false;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%dx%d, %d in a row: %zu positions up to %d stones, %zu exact, %zu bytes, %.2f s\n",
+                N, N, K, entries.size(), options.plies, exact,
+                sizeof(BookHeader) + entries.size() * (sizeof(uint64_t) + sizeof(BookRecord)), seconds);
+    std::printf("Wrote %s\n", options.path.c_str());
+    return true;
+}
+
+static void PrintUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [--board 4x4k3|4x4k4|5x5k4|6x6k4|7x7k4|15x15k5] [--plies P] [--depth D] "
+                         "[--budget MS] [--threads T] OUTPUT\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    BookOptions options;
+    options.threads = (int)std::thread::hardware_concurrency();
+    const char* board = "4x4k4";
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--board") == 0 && i + 1 < argc) {
+            board = argv[++i];
+        } else if (std::strcmp(argv[i], "--plies") == 0 && i + 1 < argc) {
+            options.plies = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            options.depth = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            options.budgetMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && options.path.empty()) {
+            options.path = argv[i];
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const BoardDefaults* defaults = nullptr;
+    for (const BoardDefaults& entry : BOARD_DEFAULTS) {
+        if (std::strcmp(board, entry.name) == 0) {
+            defaults = &entry;
+        }
+    }
+    if (!defaults || options.path.empty() || options.plies < -1 || options.depth < -1) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (options.plies < 0) {
+        options.plies = defaults->plies;
+    }
+    if (options.depth < 0) {
+        options.depth = defaults->depth;
+    }
+    options.threads = std::max(options.threads, 1);
+
+    bool ok;
+    if (std::strcmp(board, "4x4k3") == 0) {
+        ok = BuildBook<4, 3>(options);
+    } else if (std::strcmp(board, "4x4k4") == 0) {
+        ok = BuildBook<4, 4>(options);
+    } else if (std::strcmp(board, "5x5k4") == 0) {
+        ok = BuildBook<5, 4>(options);
+    } else if (std::strcmp(board, "6x6k4") == 0) {
+        ok = BuildBook<6, 4>(options);
+    } else if (std::strcmp(board, "7x7k4") == 0) {
+        ok = BuildBook<7, 4>(options);
+    } else if (std::strcmp(board, "15x15k5") == 0) {
+        ok = BuildBook<15, 5>(options);
+    } else {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -25,7 +25,7 @@ windres resources.rc -O coff -o resources.res
 
 :: Compile the application including resources
 echo Compiling with g++...
-g++ -std=c++17 -O2 -Wall -DWIN32 -mwindows -o build\Release\XOGame.exe main.cpp xo_game.cpp ai_player.cpp resources.res -lgdi32 -luser32 -lcomctl32 -lmsimg32
+g++ -std=c++17 -O2 -Wall -DWIN32 -mwindows -o build\Release\XOGame.exe main.cpp xo_game.cpp gdi_renderer.cpp ui_layout.cpp scene_painter.cpp scene_model.cpp pixel_renderer.cpp frame_stats.cpp ai_player.cpp transposition_table.cpp perfect_play.cpp async_search.cpp game_core.cpp thread_pool.cpp board_status.cpp opening_book.cpp game_record.cpp mapped_file.cpp move_list.cpp resources.res -lgdi32 -luser32 -lcomctl32 -lmsimg32
 
 echo.
 if %ERRORLEVEL% neq 0 (
@@ -0,0 +1,245 @@
+#include "frame_stats.h"
+#include "pixel_renderer.h"
+#include "scene_painter.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Renders every screen of the game through PixelRenderer, timing each frame and
+// comparing the images with a golden file, so layout and drawing changes can be
+// checked and measured without Windows.
+//
+// Usage: frame_render --record GOLDEN [--repeat R] [--ppm DIR] [--trace FILE]
+//        frame_render [--repeat R] [--ppm DIR] [--trace FILE] GOLDEN
+//        frame_render [--repeat R] [--ppm DIR] [--trace FILE]
+//   --record writes the checksum of every scene to GOLDEN; with a GOLDEN file the frames
+//   are compared with it and any difference fails the check. Each scene is drawn R times
+//   (default 200) into the same buffer and the fastest, mean, p50 and p99 frame times
+//   reported, timed with the same FrameStats the window uses. --ppm saves each frame as
+//   DIR/NAME.ppm for inspection; --trace saves every frame as Chrome trace-event JSON.
+//
+// Golden file, one line per scene after the header:
+//
+//   xo-frames 1 WIDTHxHEIGHT
+//   NAME CHECKSUM
+//
+//   CHECKSUM is PixelRenderer::Checksum in hex. Text is drawn as blocks, so the images
+//   depend on the layout but not on any font.
+
+struct NamedScene {
+    std::string name;
+    SceneState scene;
+    GameCore game;
+};
+
+// Plays cells (row * 3 + col) in order from a fresh human vs human game
+static void PlayCells(GameCore& game, std::initializer_list<int> cells) {
+    game.Start(PlayerType::Human, PlayerType::Human);
+    for (int cell : cells) {
+        game.Play(cell / 3, cell % 3);
+    }
+}
+
+static std::vector<NamedScene> Scenes() {
+    std::vector<NamedScene> scenes(9);
+
+    scenes[0].name = "welcome";
+
+    scenes[1].name = "welcome_hover_start";
+    scenes[1].scene.hoveredButton = 7;
+
+    scenes[2].name = "welcome_human_vs_human";
+    scenes[2].scene.oPlayerType = PlayerType::Human;
+
+    scenes[3].name = "welcome_ai_vs_ai_hard";
+    scenes[3].scene.xPlayerType = PlayerType::AI;
+    scenes[3].scene.difficulty = AIDifficulty::Hard;
+
+    scenes[4].name = "game_empty";
+    scenes[4].scene.screen = GameScreen::Game;
+    scenes[4].scene.statusText = L"Player X's turn (Human)";
+    PlayCells(scenes[4].game, {});
+
+    scenes[5].name = "game_hover_cell";
+    scenes[5].scene.screen = GameScreen::Game;
+    scenes[5].scene.hoverRow = 1;
+    scenes[5].scene.hoverCol = 2;
+    scenes[5].scene.statusText = L"Player O's turn (AI)";
+    PlayCells(scenes[5].game, {4});
+
+    scenes[6].name = "game_midgame";
+    scenes[6].scene.screen = GameScreen::Game;
+    scenes[6].scene.hoveredButton = 0;
+    scenes[6].scene.statusText = L"Player X's turn (Human)";
+    PlayCells(scenes[6].game, {4, 0, 2, 6});
+
+    scenes[7].name = "gameover_x_wins";
+    scenes[7].scene.screen = GameScreen::GameOver;
+    PlayCells(scenes[7].game, {0, 3, 1, 4, 2});
+
+    scenes[8].name = "gameover_draw";
+    scenes[8].scene.screen = GameScreen::GameOver;
+    scenes[8].scene.hoveredButton = 1;
+    PlayCells(scenes[8].game, {4, 0, 8, 2, 1, 7, 6, 3, 5});
+
+    for (NamedScene& named : scenes) {
+        named.scene.game = &named.game;
+    }
+    return scenes;
+}
+
+static bool ReadGolden(const char* path, std::vector<std::pair<std::string, uint64_t>>& golden) {
+    std::FILE* file = std::fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    int width = 0;
+    int height = 0;
+    bool ok = std::fscanf(file, "xo-frames 1 %dx%d", &width, &height) == 2 &&
+              width == UiLayout::WINDOW_WIDTH && height == UiLayout::WINDOW_HEIGHT;
+    char name[128];
+    uint64_t checksum;
+    while (ok && std::fscanf(file, "%127s %" SCNx64, name, &checksum) == 2) {
+        golden.emplace_back(name, checksum);
+    }
+    ok = ok && std::feof(file);
+
+    std::fclose(file);
+    return ok;
+}
+
+static void PrintUsage(const char* program) {
+    std::fprintf(stderr,
+                 "Usage: %s --record GOLDEN [--repeat R] [--ppm DIR] [--trace FILE]\n"
+                 "       %s [--repeat R] [--ppm DIR] [--trace FILE] [GOLDEN]\n",
+                 program, program);
+}
+
+int main(int argc, char* argv[]) {
+    const char* recordPath = nullptr;
+    const char* goldenPath = nullptr;
+    const char* ppmDir = nullptr;
+    const char* tracePath = nullptr;
+    int repeat = 200;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(std::atoi(argv[++i]), 1);
+        } else if (std::strcmp(argv[i], "--ppm") == 0 && i + 1 < argc) {
+            ppmDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (argv[i][0] != '-' && !goldenPath) {
+            goldenPath = argv[i];
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (recordPath && goldenPath) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> golden;
+    if (goldenPath && !ReadGolden(goldenPath, golden)) {
+        std::fprintf(stderr, "Cannot read golden file %s\n", goldenPath);
+        return 1;
+    }
+
+    std::vector<NamedScene> scenes = Scenes();
+    std::vector<std::pair<std::string, uint64_t>> current;
+
+    // One renderer and layout for every frame, as the window keeps them
+    PixelRenderer renderer;
+    renderer.Resize(UiLayout::WINDOW_WIDTH, UiLayout::WINDOW_HEIGHT);
+    UiLayout layout;
+    FrameStats stats(tracePath ? scenes.size() * repeat : 0);
+
+    std::printf("%-24s %10s %10s %8s %8s  %s\n", "scene", "best us", "mean us", "p50 us", "p99 us", "checksum");
+    for (const NamedScene& named : scenes) {
+        // Laid out once per scene, as the window does on a screen change
+        layout.Update(named.scene);
+        stats.ResetHistograms();
+        double best = 1e300;
+        double total = 0.0;
+        for (int i = 0; i < repeat; i++) {
+            auto start = FrameStats::Clock::now();
+            ScenePainter::Paint(renderer, named.scene, layout);
+            auto end = FrameStats::Clock::now();
+            stats.Record(FramePhase::Draw, start, end);
+            double micros = std::chrono::duration<double, std::micro>(end - start).count();
+            best = std::min(best, micros);
+            total += micros;
+        }
+
+        // Percentiles are bucket bounds, within 25% of the exact value
+        const RollingHistogram& draw = stats.Histogram(FramePhase::Draw);
+        uint64_t checksum = renderer.Checksum();
+        current.emplace_back(named.name, checksum);
+        std::printf("%-24s %10.1f %10.1f %8u %8u  %016" PRIx64 "\n", named.name.c_str(), best, total / repeat,
+                    (unsigned)draw.Percentile(0.5), (unsigned)draw.Percentile(0.99), checksum);
+
+        if (ppmDir) {
+            std::string path = std::string(ppmDir) + "/" + named.name + ".ppm";
+            if (!renderer.WritePpm(path)) {
+                std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+                return 1;
+            }
+        }
+    }
+
+    if (tracePath) {
+        if (!stats.WriteTrace(tracePath)) {
+            std::fprintf(stderr, "Cannot write %s\n", tracePath);
+            return 1;
+        }
+        std::printf("\nWrote %zu frames to %s\n", stats.TraceEventCount(), tracePath);
+    }
+
+    if (recordPath) {
+        std::FILE* file = std::fopen(recordPath, "w");
+        bool ok = file && std::fprintf(file, "xo-frames 1 %dx%d\n", UiLayout::WINDOW_WIDTH,
+                                       UiLayout::WINDOW_HEIGHT) > 0;
+        for (size_t i = 0; ok && i < current.size(); i++) {
+            ok = std::fprintf(file, "%s %016" PRIx64 "\n", current[i].first.c_str(), current[i].second) > 0;
+        }
+        ok = file && (std::fclose(file) == 0) && ok;
+        if (!ok) {
+            std::fprintf(stderr, "Cannot write %s\n", recordPath);
+            return 1;
+        }
+        std::printf("\nWrote %s\n", recordPath);
+        return 0;
+    }
+
+    if (!goldenPath) {
+        return 0;
+    }
+
+    // Every golden scene must still exist and draw the same pixels
+    int differences = 0;
+    for (const auto& expected : golden) {
+        auto actual = std::find_if(current.begin(), current.end(),
+                                   [&](const auto& entry) { return entry.first == expected.first; });
+        if (actual == current.end()) {
+            std::printf("MISSING %s\n", expected.first.c_str());
+            differences++;
+        } else if (actual->second != expected.second) {
+            std::printf("CHANGED %s golden %016" PRIx64 ", now %016" PRIx64 "\n", expected.first.c_str(),
+                        expected.second, actual->second);
+            differences++;
+        }
+    }
+
+    std::printf("\n%s\n", differences == 0 ? "Frames match the golden file" : "Frames FAILED");
+    return differences == 0 ? 0 : 1;
+}
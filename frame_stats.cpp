@@ -0,0 +1,144 @@
+#include "frame_stats.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+const char* FramePhaseName(FramePhase phase) {
+    static const char* names[FRAME_PHASE_COUNT] = {"input", "ai_search", "draw", "blit", "latency"};
+    return names[(int)phase];
+}
+
+int RollingHistogram::BucketOf(uint32_t micros) {
+    if (micros < 4) {
+        return (int)micros;
+    }
+
+    // The top two bits below the highest set bit pick one of four steps within its power of two
+    int exponent = 31;
+    while (!(micros >> exponent)) {
+        exponent--;
+    }
+    int step = (int)((micros >> (exponent - 2)) & 3);
+    return (exponent - 1) * 4 + step;
+}
+
+uint32_t RollingHistogram::BucketLimit(int bucket) {
+    if (bucket < 4) {
+        return (uint32_t)bucket;
+    }
+    int exponent = bucket / 4 + 1;
+    uint64_t step = (uint64_t)(bucket % 4);
+    uint64_t limit = ((4 + step + 1) << (exponent - 2)) - 1;
+    return (uint32_t)std::min<uint64_t>(limit, UINT32_MAX);
+}
+
+void RollingHistogram::Add(uint32_t micros) {
+    // Once the window is full the oldest sample makes room
+    if (m_count == WINDOW) {
+        uint32_t oldest = m_samples[m_next];
+        m_buckets[BucketOf(oldest)]--;
+        m_sum -= oldest;
+    } else {
+        m_count++;
+    }
+    m_samples[m_next] = micros;
+    m_next = (m_next + 1) % WINDOW;
+    m_buckets[BucketOf(micros)]++;
+    m_sum += micros;
+}
+
+void RollingHistogram::Reset() {
+    m_next = 0;
+    m_count = 0;
+    m_sum = 0;
+    m_buckets.fill(0);
+}
+
+uint32_t RollingHistogram::Max() const {
+    // Until the window first fills, the samples are the first m_count slots
+    uint32_t largest = 0;
+    for (int i = 0; i < m_count; i++) {
+        largest = std::max(largest, m_samples[i]);
+    }
+    return largest;
+}
+
+uint32_t RollingHistogram::Percentile(double fraction) const {
+    if (m_count == 0) {
+        return 0;
+    }
+
+    // Rank of the sample wanted, 1-based
+    int rank = std::max(1, std::min(m_count, (int)(fraction * m_count + 0.999999)));
+    int seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += m_buckets[bucket];
+        if (seen >= rank) {
+            return BucketLimit(bucket);
+        }
+    }
+    return BucketLimit(BUCKETS - 1);
+}
+
+FrameStats::FrameStats(size_t traceCapacity) : m_origin(Clock::now()), m_trace(traceCapacity) {}
+
+void FrameStats::Record(FramePhase phase, Clock::time_point start, Clock::time_point end) {
+    int64_t duration = std::max<int64_t>(Micros(end) - Micros(start), 0);
+    m_histograms[(int)phase].Add((uint32_t)std::min<int64_t>(duration, UINT32_MAX));
+
+    if (!m_trace.empty()) {
+        m_trace[m_traceNext] = {phase, Micros(start), duration};
+        m_traceNext = (m_traceNext + 1) % m_trace.size();
+        m_traceCount = std::min(m_traceCount + 1, m_trace.size());
+    }
+}
+
+void FrameStats::InputArrived(Clock::time_point time) {
+    if (!m_inputPending) {
+        m_inputPending = true;
+        m_inputTime = time;
+    }
+}
+
+void FrameStats::FramePresented(Clock::time_point time) {
+    if (m_inputPending) {
+        m_inputPending = false;
+        Record(FramePhase::Latency, m_inputTime, time);
+    }
+}
+
+void FrameStats::ResetHistograms() {
+    for (RollingHistogram& histogram : m_histograms) {
+        histogram.Reset();
+    }
+}
+
+bool FrameStats::WriteTrace(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    // Complete ("X") events; the AI search and input latency overlap the frame work they
+    // span, so each gets a track of its own to keep the main track properly nested
+    static const int tracks[FRAME_PHASE_COUNT] = {1, 2, 1, 1, 3};
+    static const char* trackNames[] = {"ui", "ai", "latency"};
+    bool ok = std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [") > 0;
+    for (int track = 1; track <= 3 && ok; track++) {
+        ok = std::fprintf(file,
+                          "%s\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                          "\"args\": {\"name\": \"%s\"}}",
+                          (track > 1) ? "," : "", track, trackNames[track - 1]) > 0;
+    }
+    size_t first = (m_traceNext + m_trace.size() - m_traceCount) % std::max<size_t>(m_trace.size(), 1);
+    for (size_t i = 0; i < m_traceCount && ok; i++) {
+        const TraceEvent& event = m_trace[(first + i) % m_trace.size()];
+        ok = std::fprintf(file,
+                          ",\n  {\"name\": \"%s\", \"cat\": \"frame\", \"ph\": \"X\", \"ts\": %" PRId64
+                          ", \"dur\": %" PRId64 ", \"pid\": 1, \"tid\": %d}",
+                          FramePhaseName(event.phase), event.start, event.duration, tracks[(int)event.phase]) > 0;
+    }
+    ok = ok && std::fprintf(file, "\n]}\n") > 0;
+
+    return (std::fclose(file) == 0) && ok;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Where the time between an input and the frame that answers it goes. Portable, so the
+// window and the console tools measure the same way.
+enum class FramePhase {
+    Input,      // Handling a mouse or keyboard message
+    AISearch,   // From asking the AI for a move to receiving it
+    Draw,       // Painting the scene into the back buffer
+    Blit,       // Copying the back buffer to the window
+    Latency     // From a click or key press to the end of the frame showing its effect
+};
+constexpr int FRAME_PHASE_COUNT = 5;
+
+const char* FramePhaseName(FramePhase phase);
+
+// Microsecond durations of the last WINDOW samples, in logarithmic buckets with four
+// steps per power of two, so percentiles are within 25% at any scale. Adding a sample
+// never allocates.
+class RollingHistogram {
+public:
+    static constexpr int WINDOW = 512;
+    static constexpr int BUCKETS = 128;
+
+    void Add(uint32_t micros);
+    void Reset();
+
+    int Count() const { return m_count; }
+    double Mean() const { return m_count ? (double)m_sum / m_count : 0.0; }
+    uint32_t Max() const;
+
+    // Upper bound of the bucket holding the sample at fraction (0..1) of the window, or 0
+    // when there are no samples
+    uint32_t Percentile(double fraction) const;
+
+    static int BucketOf(uint32_t micros);
+    static uint32_t BucketLimit(int bucket);    // Largest value in bucket
+
+private:
+    std::array<uint32_t, WINDOW> m_samples = {};
+    int m_next = 0;
+    int m_count = 0;
+    uint64_t m_sum = 0;
+    std::array<uint16_t, BUCKETS> m_buckets = {};
+};
+
+// Per-phase histograms plus a ring of the most recent timed events, which can be saved
+// as Chrome trace-event JSON (chrome://tracing or ui.perfetto.dev). Meant for one
+// thread: time work on other threads from the thread that starts and finishes it.
+class FrameStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps the last traceCapacity events for WriteTrace; 0 records histograms only
+    explicit FrameStats(size_t traceCapacity = 4096);
+
+    void Record(FramePhase phase, Clock::time_point start, Clock::time_point end);
+
+    // Times the enclosing block as one phase
+    class Scope {
+    public:
+        Scope(FrameStats& stats, FramePhase phase) : m_stats(stats), m_phase(phase), m_start(Clock::now()) {}
+        ~Scope() { m_stats.Record(m_phase, m_start, Clock::now()); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameStats& m_stats;
+        FramePhase m_phase;
+        Clock::time_point m_start;
+    };
+
+    // Input latency: the earliest input since the last frame starts the clock, and the
+    // next FramePresented records it. CancelInput drops an input that changed nothing.
+    void InputArrived(Clock::time_point time);
+    void CancelInput() { m_inputPending = false; }
+    void FramePresented(Clock::time_point time);
+
+    const RollingHistogram& Histogram(FramePhase phase) const { return m_histograms[(int)phase]; }
+    void ResetHistograms();
+
+    size_t TraceEventCount() const { return m_traceCount; }
+
+    // Saves the traced events, oldest first; returns false if the file cannot be written
+    bool WriteTrace(const std::string& path) const;
+
+private:
+    struct TraceEvent {
+        FramePhase phase;
+        int64_t start;      // Microseconds since the stats were created
+        int64_t duration;
+    };
+
+    int64_t Micros(Clock::time_point time) const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time - m_origin).count();
+    }
+
+    Clock::time_point m_origin;
+    std::array<RollingHistogram, FRAME_PHASE_COUNT> m_histograms;
+    std::vector<TraceEvent> m_trace;    // Ring of the last events, allocated once
+    size_t m_traceNext = 0;
+    size_t m_traceCount = 0;
+    bool m_inputPending = false;
+    Clock::time_point m_inputTime;
+};
@@ -0,0 +1,277 @@
+#include "ai_player.h"
+#include "game_record.h"
+#include "mapped_file.h"
+#include "move_list.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Aggregate statistics over files of recorded 3x3 games: results, opening
+// frequencies, win rates by first move, and how often each side played a move
+// that Hard's perfect-play evaluation rates below the best one.
+//
+// Usage: game_analyzer [--threads T] [--top N] FILE...
+//   Each FILE is a game record file (game_record.h, e.g. from self_play --record) or a
+//   move-list log (move_list.h); record files are told apart by their header. Files
+//   are memory-mapped and split into shards that are analyzed in parallel, and the
+//   shards' statistics are summed into one report.
+
+struct Analysis {
+    uint64_t games = 0;
+    uint64_t moves = 0;
+    uint64_t invalid = 0;                                               // Unreadable lines or illegal games
+    std::array<uint64_t, 4> results = {};                               // By GameResult; Playing is unfinished
+    std::array<std::array<uint64_t, 4>, BOARD_CELLS> firstMoves = {};   // By first cell, then result
+    std::array<uint64_t, BOARD_CELLS * BOARD_CELLS> openings = {};      // By first cell * 9 + second cell
+    std::array<uint64_t, 2> optimal = {};                               // By side: moves keeping the best value
+    std::array<uint64_t, 2> inaccuracies = {};                          // Same outcome, but slower win or quicker loss
+    std::array<uint64_t, 2> blunders = {};                              // Gave away a win or a draw
+
+    void Add(const Analysis& other) {
+        games += other.games;
+        moves += other.moves;
+        invalid += other.invalid;
+        for (int i = 0; i < 4; i++) {
+            results[i] += other.results[i];
+            for (int cell = 0; cell < BOARD_CELLS; cell++) {
+                firstMoves[cell][i] += other.firstMoves[cell][i];
+            }
+        }
+        for (size_t i = 0; i < openings.size(); i++) {
+            openings[i] += other.openings[i];
+        }
+        for (int side = 0; side < 2; side++) {
+            optimal[side] += other.optimal[side];
+            inaccuracies[side] += other.inaccuracies[side];
+            blunders[side] += other.blunders[side];
+        }
+    }
+};
+
+// Win, draw or loss for the side a score belongs to
+static int Outcome(int score) {
+    return (score > 0) - (score < 0);
+}
+
+// Replays one game, rating every move with the AI's evaluation of the positions before
+// and after it. Games with an illegal move count as invalid.
+static void AnalyzeGame(const GameRecord& record, AIPlayer& ai, Analysis& analysis) {
+    std::array<Bitboard, BOARD_CELLS + 1> positions;
+    positions[0] = Bitboard();
+    int count = record.moveCount;
+    if (count > BOARD_CELLS) {
+        analysis.invalid++;
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const Bitboard& board = positions[i];
+        int cell = record.moves[i];
+        if (cell >= BOARD_CELLS || !board.IsEmpty(cell) || board.HasWon(Mark::X) || board.HasWon(Mark::O)) {
+            analysis.invalid++;
+            return;
+        }
+        positions[i + 1] = board.Play(cell, board.ToMove());
+    }
+
+    // Scores are for the side to move, so a move's value is minus the score after it
+    std::array<int, BOARD_CELLS + 1> cells;
+    std::array<int, BOARD_CELLS + 1> scores;
+    ai.EvaluateBatch(positions.data(), count + 1, cells.data(), scores.data());
+    for (int i = 0; i < count; i++) {
+        int side = i & 1;
+        int best = scores[i];
+        int played = -scores[i + 1];
+        if (played == best) {
+            analysis.optimal[side]++;
+        } else if (Outcome(played) < Outcome(best)) {
+            analysis.blunders[side]++;
+        } else {
+            analysis.inaccuracies[side]++;
+        }
+    }
+
+    const Bitboard& final = positions[count];
+    GameResult result = final.HasWon(Mark::X) ? GameResult::XWon :
+                        final.HasWon(Mark::O) ? GameResult::OWon :
+                        final.IsFull() ? GameResult::Draw : GameResult::Playing;
+
+    analysis.games++;
+    analysis.moves += count;
+    analysis.results[(int)result]++;
+    if (count >= 1) {
+        analysis.firstMoves[record.moves[0]][(int)result]++;
+    }
+    if (count >= 2) {
+        analysis.openings[record.moves[0] * BOARD_CELLS + record.moves[1]]++;
+    }
+}
+
+// Shards of a move-list log hold the lines starting inside them
+static void AnalyzeMoveListShard(const char* data, size_t size, size_t begin, size_t end, AIPlayer& ai,
+                                 Analysis& analysis) {
+    // A line running into this shard from the previous one belongs to that shard
+    const char* cursor = data + begin;
+    if (begin > 0 && data[begin - 1] != '\n') {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', size - begin));
+        cursor = newline ? newline + 1 : data + size;
+    }
+
+    GameRecord record;
+    MoveListLine kind;
+    while (cursor < data + end) {
+        cursor = ParseMoveListLine(cursor, data + size, record, kind);
+        if (kind == MoveListLine::Game) {
+            AnalyzeGame(record, ai, analysis);
+        } else if (kind == MoveListLine::Invalid) {
+            analysis.invalid++;
+        }
+    }
+}
+
+// Analyzes one mapped file on the pool; false if it is a record file for another board
+// size or a damaged one
+static bool AnalyzeFile(const MappedFile& file, ThreadPool& pool, Analysis& total) {
+    const uint8_t* data = file.Data();
+    size_t size = file.Size();
+
+    RecordFileHeader header;
+    std::vector<RecordBlockRef> blocks;
+    bool isRecordFile = size >= sizeof(uint32_t) && std::memcmp(data, &RECORD_MAGIC, sizeof(uint32_t)) == 0;
+    if (isRecordFile && (!IndexRecordBlocks(data, size, header, blocks) || header.size != 3)) {
+        return false;
+    }
+
+    // Several shards per thread so uneven shards balance out
+    size_t shards = isRecordFile ? blocks.size() : std::min<size_t>(std::max<size_t>(size / 4096, 1), pool.Size() * 16);
+    std::vector<Analysis> results(shards);
+    std::vector<char> damaged(shards, 0);
+
+    pool.ParallelFor(shards, [&](size_t begin, size_t end) {
+        AIPlayer ai;
+        for (size_t shard = begin; shard < end; shard++) {
+            if (isRecordFile) {
+                const RecordBlockRef& block = blocks[shard];
+                RecordBlockCursor cursor(data + block.offset, block.bytes, block.games, header.size);
+                while (const GameRecord* record = cursor.Next()) {
+                    AnalyzeGame(*record, ai, results[shard]);
+                }
+                damaged[shard] = cursor.Failed();
+            } else {
+                AnalyzeMoveListShard(reinterpret_cast<const char*>(data), size,
+                                     size * shard / shards, size * (shard + 1) / shards, ai, results[shard]);
+            }
+        }
+    });
+
+    for (size_t shard = 0; shard < shards; shard++) {
+        total.Add(results[shard]);
+    }
+    return std::find(damaged.begin(), damaged.end(), 1) == damaged.end();
+}
+
+static void PrintReport(const Analysis& analysis, int top) {
+    auto percent = [](uint64_t count, uint64_t of) { return of ? 100.0 * count / of : 0.0; };
+
+    const char* resultNames[4] = {"Unfinished", "X wins", "O wins", "Draws"};
+    std::printf("\n%-12s %12s %8s\n", "Result", "games", "share");
+    for (int result : {1, 3, 2, 0}) {
+        std::printf("%-12s %12llu %7.2f%%\n", resultNames[result], (unsigned long long)analysis.results[result],
+                    percent(analysis.results[result], analysis.games));
+    }
+
+    std::printf("\n%-12s %12s %8s %8s %8s %8s\n", "First move", "games", "share", "X wins", "draws", "O wins");
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        const std::array<uint64_t, 4>& byResult = analysis.firstMoves[cell];
+        uint64_t games = byResult[0] + byResult[1] + byResult[2] + byResult[3];
+        std::printf("(%d, %d)       %12llu %7.2f%% %7.2f%% %7.2f%% %7.2f%%\n", cell / 3, cell % 3,
+                    (unsigned long long)games, percent(games, analysis.games), percent(byResult[1], games),
+                    percent(byResult[3], games), percent(byResult[2], games));
+    }
+
+    std::vector<int> order(analysis.openings.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = (int)i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&analysis](int a, int b) {
+        return analysis.openings[a] > analysis.openings[b];
+    });
+
+    std::printf("\n%-18s %12s %8s\n", "Opening (X, O)", "games", "share");
+    for (int i = 0; i < top && i < (int)order.size() && analysis.openings[order[i]] > 0; i++) {
+        int x = order[i] / BOARD_CELLS;
+        int o = order[i] % BOARD_CELLS;
+        std::printf("(%d, %d) (%d, %d)     %12llu %7.2f%%\n", x / 3, x % 3, o / 3, o % 3,
+                    (unsigned long long)analysis.openings[order[i]], percent(analysis.openings[order[i]], analysis.games));
+    }
+
+    std::printf("\n%-12s %12s %10s %12s %10s\n", "Moves by", "moves", "optimal", "inaccurate", "blunders");
+    for (int side = 0; side < 2; side++) {
+        uint64_t moves = analysis.optimal[side] + analysis.inaccuracies[side] + analysis.blunders[side];
+        std::printf("%-12s %12llu %9.2f%% %11.2f%% %9.2f%%\n", side ? "O" : "X", (unsigned long long)moves,
+                    percent(analysis.optimal[side], moves), percent(analysis.inaccuracies[side], moves),
+                    percent(analysis.blunders[side], moves));
+    }
+}
+
+static void PrintUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [--threads T] [--top N] FILE...\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    int threads = (int)std::thread::hardware_concurrency();
+    int top = 10;
+    std::vector<const char*> paths;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = std::atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (paths.empty()) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    threads = std::max(threads, 1);
+
+    ThreadPool pool(threads);
+    Analysis total;
+    bool ok = true;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const char* path : paths) {
+        MappedFile file;
+        if (!file.Open(path, MappedFile::Access::Sequential)) {
+            std::fprintf(stderr, "Cannot open %s\n", path);
+            ok = false;
+        } else if (!AnalyzeFile(file, pool, total)) {
+            std::fprintf(stderr, "%s is damaged or not a 3x3 game file; its readable games are counted\n", path);
+            ok = false;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%llu games, %llu moves from %zu files, %d threads, %.3f s (%.0f games/s)\n",
+                (unsigned long long)total.games, (unsigned long long)total.moves, paths.size(), threads, seconds,
+                seconds > 0.0 ? total.games / seconds : 0.0);
+    if (total.invalid > 0) {
+        std::printf("%llu unreadable lines or illegal games skipped\n", (unsigned long long)total.invalid);
+    }
+    PrintReport(total, top);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include "game_core.h"
+#include "game_record.h"
+
+GameCore::GameCore() 
+    : m_currentPlayer(Mark::X), 
+      m_result(GameResult::Playing), 
+      m_xPlayer(PlayerType::Human), 
+      m_oPlayer(PlayerType::AI), 
+      m_history(), 
+      m_moveCount(0) {
+}
+
+void GameCore::Start(PlayerType xPlayer, PlayerType oPlayer) {
+    m_xPlayer = xPlayer;
+    m_oPlayer = oPlayer;
+    Reset();
+}
+
+void GameCore::Reset() {
+    m_board = Bitboard();
+    m_currentPlayer = Mark::X;
+    m_result = GameResult::Playing;
+    m_moveCount = 0;
+}
+
+bool GameCore::IsLegal(int row, int col) const {
+    return !IsOver() && 
+           row >= 0 && row < GRID_SIZE && col >= 0 && col < GRID_SIZE && 
+           IsEmpty(row, col);
+}
+
+bool GameCore::Play(int row, int col) {
+    if (!IsLegal(row, col)) {
+        return false;
+    }
+    
+    int cell = row * GRID_SIZE + col;
+    m_board.Place(cell, m_currentPlayer);
+    m_history[m_moveCount++] = (int8_t)cell;
+    
+    // Check for win or draw, then pass the turn
+    UpdateResult();
+    m_currentPlayer = Opponent(m_currentPlayer);
+    return true;
+}
+
+void GameCore::Record(GameRecord& record) const {
+    record.Clear();
+    for (int i = 0; i < m_moveCount; i++) {
+        record.Add(m_history[i]);
+    }
+    record.result = m_result;
+}
+
+bool GameCore::Undo() {
+    if (m_moveCount == 0) {
+        return false;
+    }
+    
+    m_currentPlayer = Opponent(m_currentPlayer);
+    m_board.Undo(m_history[--m_moveCount], m_currentPlayer);
+    UpdateResult();
+    return true;
+}
+
+void GameCore::UpdateResult() {
+    if (m_board.HasWon(Mark::X)) {
+        m_result = GameResult::XWon;
+    } else if (m_board.HasWon(Mark::O)) {
+        m_result = GameResult::OWon;
+    } else if (m_board.IsFull()) {
+        m_result = GameResult::Draw;
+    } else {
+        m_result = GameResult::Playing;
+    }
+}
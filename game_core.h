@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "bitboard.h"
+
+enum class GameResult { Playing, XWon, OWon, Draw };
+enum class PlayerType { Human, AI };
+
+struct GameRecord;
+
+// Rules and turn order of one 3x3 game, free of any window code so it can be
+// driven by the GUI, console tools or batch simulations alike
+class GameCore {
+public:
+    static constexpr int GRID_SIZE = 3;
+    
+    GameCore();
+    
+    // Clears the board for a new game between the given player types; X moves first
+    void Start(PlayerType xPlayer, PlayerType oPlayer);
+    
+    // Clears the board, keeping the player types
+    void Reset();
+    
+    // Places the current player's mark and passes the turn. Returns false, leaving the
+    // game unchanged, if the game is over or the cell is taken or off the board.
+    bool Play(int row, int col);
+    
+    // Takes back the last move; returns false if there is none
+    bool Undo();
+    
+    bool IsLegal(int row, int col) const;
+    bool IsEmpty(int row, int col) const { return m_board.IsEmpty(row * GRID_SIZE + col); }
+    bool Has(int row, int col, Mark mark) const { return m_board.Has(row * GRID_SIZE + col, mark); }
+    
+    const Bitboard& Board() const { return m_board; }
+    Mark CurrentPlayer() const { return m_currentPlayer; }
+    GameResult Result() const { return m_result; }
+    bool IsOver() const { return m_result != GameResult::Playing; }
+    
+    PlayerType PlayerTypeOf(Mark mark) const { return (mark == Mark::X) ? m_xPlayer : m_oPlayer; }
+    bool IsAITurn() const { return !IsOver() && PlayerTypeOf(m_currentPlayer) == PlayerType::AI; }
+    
+    // Move history: cells (row * GRID_SIZE + col) in the order played, X first
+    int MoveCount() const { return m_moveCount; }
+    int MoveAt(int index) const { return m_history[index]; }
+    
+    // Copies the moves so far and the result, for saving with GameRecordWriter
+    void Record(GameRecord& record) const;
+
+private:
+    void UpdateResult();
+    
+    Bitboard m_board;
+    Mark m_currentPlayer;
+    GameResult m_result;
+    PlayerType m_xPlayer;
+    PlayerType m_oPlayer;
+    std::array<int8_t, BOARD_CELLS> m_history;
+    int m_moveCount;
+};
@@ -0,0 +1,373 @@
+#include "game_record.h"
+
+// Longest encoding of one game: two header varints and a varint per move, 2 bytes each
+static constexpr size_t MAX_GAME_BYTES = 4 + 2 * MAX_RECORD_MOVES;
+
+// Largest block payload the reader accepts, far above what the writer produces
+static constexpr uint32_t MAX_BLOCK_PAYLOAD = 16 * 1024 * 1024;
+
+static size_t PutVarint(uint8_t* out, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+GameRecordWriter::~GameRecordWriter() {
+    Close();
+}
+
+bool GameRecordWriter::Open(const std::string& path, int size, int winLength) {
+    if (m_file || size < 1 || size * size > MAX_RECORD_MOVES) {
+        return false;
+    }
+    
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        return false;
+    }
+    
+    RecordFileHeader header;
+    header.size = (uint16_t)size;
+    header.winLength = (uint16_t)winLength;
+    if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    
+    m_size = size;
+    m_games = 0;
+    m_bytes = sizeof(header);
+    m_stop = false;
+    m_failed = false;
+    m_thread = std::thread(&GameRecordWriter::WriterLoop, this);
+    return true;
+}
+
+bool GameRecordWriter::Close() {
+    if (!m_file) {
+        return true;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    
+    bool ok = (std::fclose(m_file) == 0) && !m_failed;
+    m_file = nullptr;
+    m_free.clear();
+    return ok;
+}
+
+uint64_t GameRecordWriter::GamesWritten() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_games;
+}
+
+uint64_t GameRecordWriter::BytesWritten() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+std::unique_ptr<Arena> GameRecordWriter::Submit(std::unique_ptr<Arena> block, uint32_t games) {
+    std::unique_ptr<Arena> next;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        
+        // Without an open file the games have nowhere to go
+        if (!m_file || m_stop) {
+            block->Reset();
+            return block;
+        }
+        
+        // Only waits when the disk has fallen MAX_QUEUED_BLOCKS behind
+        m_space.wait(lock, [this]() { return m_queue.size() < MAX_QUEUED_BLOCKS; });
+        m_queue.push_back(Block{std::move(block), games});
+        if (!m_free.empty()) {
+            next = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+    m_wake.notify_one();
+    
+    return next ? std::move(next) : std::make_unique<Arena>(RECORD_BLOCK_BYTES);
+}
+
+void GameRecordWriter::WriterLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            break;
+        }
+        
+        Block block = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+        
+        RecordBlockHeader header;
+        header.payloadBytes = (uint32_t)block.data->Used();
+        header.games = block.games;
+        bool ok = std::fwrite(&header, sizeof(header), 1, m_file) == 1 &&
+                  std::fwrite(block.data->Data(), 1, header.payloadBytes, m_file) == header.payloadBytes;
+        block.data->Reset();
+        
+        lock.lock();
+        if (ok) {
+            m_games += header.games;
+            m_bytes += sizeof(header) + header.payloadBytes;
+        }
+        m_failed = m_failed || !ok;
+        m_free.push_back(std::move(block.data));
+        m_space.notify_all();
+    }
+}
+
+GameRecordBuffer::GameRecordBuffer(GameRecordWriter& writer) 
+    : m_writer(writer), m_block(std::make_unique<Arena>(RECORD_BLOCK_BYTES)), 
+      m_nibbles(writer.BoardSize() * writer.BoardSize() <= 16) {
+}
+
+void GameRecordBuffer::Append(const GameRecord& record) {
+    // Start a new block unless the longest possible game still fits
+    if (m_block->Used() + MAX_GAME_BYTES > m_block->Capacity()) {
+        Flush();
+    }
+    
+    int shared = 0;
+    if (m_games > 0) {
+        int limit = std::min(record.moveCount, m_previous.moveCount);
+        while (shared < limit && record.moves[shared] == m_previous.moves[shared]) {
+            shared++;
+        }
+    }
+    
+    uint8_t bytes[MAX_GAME_BYTES];
+    size_t length = PutVarint(bytes, ((uint32_t)record.moveCount << 2) | (uint32_t)record.result);
+    length += PutVarint(bytes + length, (uint32_t)shared);
+    if (m_nibbles) {
+        for (int i = shared; i < record.moveCount; i += 2) {
+            uint8_t pair = record.moves[i] & 0x0F;
+            if (i + 1 < record.moveCount) {
+                pair |= (uint8_t)((record.moves[i + 1] & 0x0F) << 4);
+            }
+            bytes[length++] = pair;
+        }
+    } else {
+        for (int i = shared; i < record.moveCount; i++) {
+            length += PutVarint(bytes + length, record.moves[i]);
+        }
+    }
+    
+    std::copy(bytes, bytes + length, m_block->Allocate<uint8_t>(length));
+    
+    std::copy(record.moves.begin() + shared, record.moves.begin() + record.moveCount, m_previous.moves.begin() + shared);
+    m_previous.moveCount = record.moveCount;
+    m_games++;
+}
+
+void GameRecordBuffer::Flush() {
+    if (m_games == 0) {
+        return;
+    }
+    
+    m_block = m_writer.Submit(std::move(m_block), m_games);
+    m_games = 0;
+}
+
+RecordBlockCursor::RecordBlockCursor(const uint8_t* payload, size_t bytes, uint32_t games, int boardSize) 
+    : m_data(payload), m_end(bytes), m_gamesLeft(games), m_cells(boardSize * boardSize), 
+      m_nibbles(boardSize * boardSize <= 16) {
+}
+
+const GameRecord* RecordBlockCursor::Next() {
+    if (m_failed) {
+        return nullptr;
+    }
+    if (m_gamesLeft == 0) {
+        // Bytes after the last game mean the counts and the payload disagree
+        return (m_position == m_end) ? nullptr : Fail();
+    }
+    
+    const uint8_t* data = m_data;
+    size_t end = m_end;
+    size_t position = m_position;
+    int cells = m_cells;
+    GameRecord& current = m_current;
+    
+    // Varints here never exceed 5 bytes
+    auto getVarint = [&](uint32_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 35 && position < end; shift += 7) {
+            uint8_t byte = data[position++];
+            value |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    uint32_t head;
+    uint32_t shared;
+    if (!getVarint(head) || !getVarint(shared)) {
+        return Fail();
+    }
+    
+    int count = (int)(head >> 2);
+    if (count > cells || (int)shared > count || (int)shared > current.moveCount) {
+        return Fail();
+    }
+    
+    if (m_nibbles) {
+        for (int i = (int)shared; i < count; i += 2) {
+            if (position >= end) {
+                return Fail();
+            }
+            uint8_t pair = data[position++];
+            current.moves[i] = pair & 0x0F;
+            if (i + 1 < count) {
+                current.moves[i + 1] = pair >> 4;
+            }
+        }
+    } else {
+        for (int i = (int)shared; i < count; i++) {
+            uint32_t cell;
+            if (!getVarint(cell)) {
+                return Fail();
+            }
+            current.moves[i] = (uint16_t)cell;
+        }
+    }
+    
+    for (int i = (int)shared; i < count; i++) {
+        if (current.moves[i] >= cells) {
+            return Fail();
+        }
+    }
+    
+    current.moveCount = count;
+    current.result = (GameResult)(head & 3);
+    m_position = position;
+    m_gamesLeft--;
+    return &current;
+}
+
+const GameRecord* RecordBlockCursor::Fail() {
+    m_failed = true;
+    return nullptr;
+}
+
+bool IndexRecordBlocks(const uint8_t* data, size_t size, RecordFileHeader& header, 
+                       std::vector<RecordBlockRef>& blocks) {
+    blocks.clear();
+    if (size < sizeof(RecordFileHeader)) {
+        return false;
+    }
+    
+    std::copy(data, data + sizeof(header), reinterpret_cast<uint8_t*>(&header));
+    if (header.magic != RECORD_MAGIC || header.version != RECORD_VERSION || 
+        header.size < 1 || header.size * header.size > MAX_RECORD_MOVES) {
+        return false;
+    }
+    
+    size_t offset = sizeof(RecordFileHeader);
+    while (offset < size) {
+        RecordBlockHeader block;
+        if (size - offset < sizeof(block)) {
+            return false;
+        }
+        std::copy(data + offset, data + offset + sizeof(block), reinterpret_cast<uint8_t*>(&block));
+        offset += sizeof(block);
+        
+        if (block.payloadBytes > size - offset) {
+            return false;
+        }
+        blocks.push_back(RecordBlockRef{offset, block.payloadBytes, block.games});
+        offset += block.payloadBytes;
+    }
+    return true;
+}
+
+bool GameRecordReader::Open(const std::string& path) {
+    Close();
+    
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file) {
+        return false;
+    }
+    
+    RecordFileHeader header;
+    if (std::fread(&header, sizeof(header), 1, m_file) != 1 || header.magic != RECORD_MAGIC || 
+        header.version != RECORD_VERSION || header.size < 1 || header.size * header.size > MAX_RECORD_MOVES) {
+        Close();
+        return false;
+    }
+    
+    m_size = header.size;
+    m_winLength = header.winLength;
+    return true;
+}
+
+void GameRecordReader::Close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    
+    m_block.clear();
+    m_cursor = RecordBlockCursor();
+    m_size = 0;
+    m_winLength = 0;
+    m_failed = false;
+}
+
+const GameRecord* GameRecordReader::Next() {
+    if (!m_file || m_failed) {
+        return nullptr;
+    }
+    
+    while (true) {
+        if (const GameRecord* record = m_cursor.Next()) {
+            return record;
+        }
+        if (m_cursor.Failed()) {
+            m_failed = true;
+            return nullptr;
+        }
+        if (!LoadBlock()) {
+            return nullptr;
+        }
+    }
+}
+
+bool GameRecordReader::LoadBlock() {
+    RecordBlockHeader header;
+    size_t read = std::fread(&header, 1, sizeof(header), m_file);
+    if (read != sizeof(header)) {
+        // A clean end of file falls between blocks
+        m_failed = (read != 0);
+        return false;
+    }
+    
+    if (header.payloadBytes > MAX_BLOCK_PAYLOAD) {
+        m_failed = true;
+        return false;
+    }
+    
+    m_block.resize(header.payloadBytes);
+    if (std::fread(m_block.data(), 1, m_block.size(), m_file) != m_block.size()) {
+        m_failed = true;
+        return false;
+    }
+    
+    m_cursor = RecordBlockCursor(m_block.data(), m_block.size(), header.games, m_size);
+    return true;
+}
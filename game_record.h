@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "arena.h"
+#include "game_core.h"
+
+// Game record file layout, little-endian:
+//
+//   RecordFileHeader
+//   blocks to the end of the file, each a RecordBlockHeader and payloadBytes of games
+//
+// Each game in a block is
+//
+//   varint   (moveCount << 2) | result     result as GameResult: 0 unfinished, 1 X won, 2 O won, 3 draw
+//   varint   moves shared with the previous game of the block (0 for the block's first game)
+//   the remaining moves, as cells (row * size + col): two per byte, low nibble first and
+//   padded to a whole byte, on boards of up to 16 cells; one varint each on larger ones
+//
+// Simulated games repeat their openings, so storing only what differs from the
+// previous game is the block compression: a Hard vs Hard game costs two bytes.
+// Every block starts afresh, so blocks decode on their own.
+constexpr uint32_t RECORD_MAGIC = 0x52474F58;     // "XOGR"
+constexpr uint32_t RECORD_VERSION = 1;
+
+struct RecordFileHeader {
+    uint32_t magic = RECORD_MAGIC;
+    uint32_t version = RECORD_VERSION;
+    uint16_t size = 0;          // Board is size x size
+    uint16_t winLength = 0;     // Stones in a row that win
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(RecordFileHeader) == 16, "record header layout is part of the file format");
+
+struct RecordBlockHeader {
+    uint32_t payloadBytes = 0;
+    uint32_t games = 0;
+};
+
+// Blocks are handed to the writer once they hold this many bytes
+constexpr size_t RECORD_BLOCK_BYTES = 64 * 1024;
+
+// Longest game on the largest supported board (15x15)
+constexpr int MAX_RECORD_MOVES = 225;
+
+// Cells of one game in the order played, X first, and how it ended
+struct GameRecord {
+    GameResult result = GameResult::Playing;
+    int moveCount = 0;
+    std::array<uint16_t, MAX_RECORD_MOVES> moves;
+
+    void Clear() {
+        result = GameResult::Playing;
+        moveCount = 0;
+    }
+
+    // Appends a move; false once the record is full
+    bool Add(int cell) {
+        if (moveCount >= MAX_RECORD_MOVES) {
+            return false;
+        }
+        moves[moveCount++] = (uint16_t)cell;
+        return true;
+    }
+
+    bool operator==(const GameRecord& other) const {
+        return result == other.result && moveCount == other.moveCount &&
+               std::equal(moves.begin(), moves.begin() + moveCount, other.moves.begin());
+    }
+    bool operator!=(const GameRecord& other) const { return !(*this == other); }
+};
+
+// Owns a record file and a thread that writes finished blocks to it, so simulator
+// threads never wait on the disk. Games arrive through GameRecordBuffer.
+class GameRecordWriter {
+public:
+    GameRecordWriter() = default;
+    ~GameRecordWriter();
+
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+    // Creates the file for size x size boards won by winLength in a row and starts the
+    // writer thread; false if the file cannot be created or another is open
+    bool Open(const std::string& path, int size, int winLength);
+
+    // Writes the queued blocks and closes the file; false if any write failed. Flush or
+    // destroy every buffer first, since games still in a buffer are not queued.
+    bool Close();
+
+    bool IsOpen() const { return m_file != nullptr; }
+    int BoardSize() const { return m_size; }
+
+    // Games and bytes written so far, headers included
+    uint64_t GamesWritten() const;
+    uint64_t BytesWritten() const;
+
+private:
+    friend class GameRecordBuffer;
+
+    // Full blocks waiting for the disk before Submit makes simulator threads wait
+    static constexpr size_t MAX_QUEUED_BLOCKS = 64;
+
+    struct Block {
+        std::unique_ptr<Arena> data;
+        uint32_t games;
+    };
+
+    // Queues a filled block and returns an empty one to fill next, recycled when possible
+    std::unique_ptr<Arena> Submit(std::unique_ptr<Arena> block, uint32_t games);
+    void WriterLoop();
+
+    std::FILE* m_file = nullptr;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_space;
+    std::deque<Block> m_queue;
+    std::vector<std::unique_ptr<Arena>> m_free;
+    uint64_t m_games = 0;
+    uint64_t m_bytes = 0;
+    int m_size = 0;
+    bool m_stop = false;
+    bool m_failed = false;
+};
+
+// Encodes one thread's games into blocks, taking the writer's lock only to hand over
+// a full block. Not thread-safe: give each simulator thread its own buffer.
+class GameRecordBuffer {
+public:
+    explicit GameRecordBuffer(GameRecordWriter& writer);
+    ~GameRecordBuffer() { Flush(); }
+
+    GameRecordBuffer(const GameRecordBuffer&) = delete;
+    GameRecordBuffer& operator=(const GameRecordBuffer&) = delete;
+
+    void Append(const GameRecord& record);
+
+    // Hands over the games appended so far as a block of their own
+    void Flush();
+
+private:
+    GameRecordWriter& m_writer;
+    std::unique_ptr<Arena> m_block;
+    uint32_t m_games = 0;
+    GameRecord m_previous;
+    bool m_nibbles;
+};
+
+// Decodes the games of one block held in memory
+class RecordBlockCursor {
+public:
+    RecordBlockCursor() = default;
+    RecordBlockCursor(const uint8_t* payload, size_t bytes, uint32_t games, int boardSize);
+
+    // The next game, valid until the following call; nullptr after the block's last game
+    // or at damaged data, which Failed then reports
+    const GameRecord* Next();
+    bool Failed() const { return m_failed; }
+
+private:
+    const GameRecord* Fail();
+
+    const uint8_t* m_data = nullptr;
+    size_t m_end = 0;
+    size_t m_position = 0;
+    uint32_t m_gamesLeft = 0;
+    int m_cells = 0;
+    bool m_nibbles = false;
+    bool m_failed = false;
+    GameRecord m_current;
+};
+
+// Where one block's games sit in a record file held in memory
+struct RecordBlockRef {
+    size_t offset;      // Start of the payload
+    uint32_t bytes;
+    uint32_t games;
+};
+
+// Checks the header of a record file held in memory (e.g. a MappedFile) and lists its
+// blocks by walking their headers, so they can be decoded in parallel. False if the
+// header is not a record file's or a block runs past the end.
+bool IndexRecordBlocks(const uint8_t* data, size_t size, RecordFileHeader& header,
+                       std::vector<RecordBlockRef>& blocks);
+
+// Reads a record file one block at a time, so memory stays at one block whatever
+// the file size
+class GameRecordReader {
+public:
+    GameRecordReader() = default;
+    ~GameRecordReader() { Close(); }
+
+    GameRecordReader(const GameRecordReader&) = delete;
+    GameRecordReader& operator=(const GameRecordReader&) = delete;
+
+    // Opens the file and checks its header; false if it is missing or not a record file
+    bool Open(const std::string& path);
+    void Close();
+
+    int BoardSize() const { return m_size; }
+    int WinLength() const { return m_winLength; }
+
+    // The next game, valid until the following call; nullptr at the end of the file or
+    // at damaged data, which Failed then reports
+    const GameRecord* Next();
+    bool Failed() const { return m_failed; }
+
+private:
+    bool LoadBlock();
+
+    std::FILE* m_file = nullptr;
+    std::vector<uint8_t> m_block;
+    RecordBlockCursor m_cursor;
+    int m_size = 0;
+    int m_winLength = 0;
+    bool m_failed = false;
+};
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "grid_board.h"
+#include "search_stats.h"
+#include "transposition_table.h"
+
+// Score of a won position for the side that won it, less the stones on the board
+// when it was won, so quicker wins score higher. Depends only on the position,
+// which keeps transposition table entries valid across searches.
+constexpr int WIN_SCORE = 10000;
+
+// Heuristic leaf scores stay well inside the range of proven results
+constexpr int HEURISTIC_LIMIT = WIN_SCORE / 2;
+
+constexpr bool IsProvenScore(int score) {
+    return score > HEURISTIC_LIMIT || score < -HEURISTIC_LIMIT;
+}
+
+// Open-line heuristic for the side to move on a GridBoard: every run still
+// winnable by one side only is worth 4^(stones - 1) to that side
+template <int N, int K>
+int EvaluatePosition(const GridBoard<N, K>& board, Mark toMove) {
+    Mark opponent = Opponent(toMove);
+    int score = 0;
+
+    for (int window = 0; window < LineTable<N, K>::WINDOWS; window++) {
+        int mine = board.LineCount(window, toMove);
+        int theirs = board.LineCount(window, opponent);
+        if (mine > 0 && theirs == 0) {
+            score += 1 << (2 * (mine - 1));
+        } else if (theirs > 0 && mine == 0) {
+            score -= 1 << (2 * (theirs - 1));
+        }
+    }
+
+    return std::clamp(score, -HEURISTIC_LIMIT, HEURISTIC_LIMIT);
+}
+
+// Same heuristic on the 3x3 bitboard, one mask test per line
+inline int EvaluatePosition(const Bitboard& board, Mark toMove) {
+    uint16_t mine = board.Mask(toMove);
+    uint16_t theirs = board.Mask(Opponent(toMove));
+    int score = 0;
+
+    for (uint16_t line : WIN_LINES) {
+        if (!(line & theirs) && (line & mine)) {
+            score += 1 << (2 * (PopCount(line & mine) - 1));
+        } else if (!(line & mine) && (line & theirs)) {
+            score -= 1 << (2 * (PopCount(line & theirs) - 1));
+        }
+    }
+
+    return score;
+}
+
+struct SearchLimits {
+    int maxDepth = 0;                                  // Plies; 0 searches to the end of the game
+    std::chrono::milliseconds budget{0};               // Wall-clock budget; 0 means no limit
+    const std::atomic<bool>* cancel = nullptr;         // Stops the search early when set
+    int threads = 1;                                   // Search threads sharing the transposition table
+    SearchStats* stats = nullptr;                      // Receives the counters and root moves, if given
+    bool timeRootMoves = false;                        // Fill in the root moves' seconds (two clock reads each)
+    SearchTraceSink* trace = nullptr;                  // Main thread's events, in XO_SEARCH_TRACE builds
+};
+
+struct SearchResult {
+    int cell = -1;          // Best cell for the side to move, -1 if the game is over
+    int score = 0;          // Value of that move for the side to move
+    int depth = 0;          // Deepest fully searched iteration
+    uint64_t nodes = 0;     // Positions visited, summed over all threads
+    bool complete = false;  // True if the score is exact rather than depth-limited or cut short
+};
+
+// Iterative-deepening negamax alpha-beta over any board with the GridBoard
+// interface (Bitboard for 3x3, GridBoard<N, K> otherwise). Scores are from
+// the side to move.
+//
+// With more than one thread the search runs Lazy SMP style: helper threads
+// search the same position into the shared, lock-free transposition table.
+// Each helper starts its root loop at a different move and odd helpers skip
+// the first ply, so the threads spread over the root moves and fill the
+// table with results the main thread then finds. Only the main thread's
+// answer is returned.
+template <typename Board>
+class GameSearch {
+public:
+    explicit GameSearch(TranspositionTable& table) : m_table(table) {}
+
+    // Full search to the end of the game; score receives the best move's value
+    int BestMove(Board board, int& score) {
+        SearchResult result = Search(board, SearchLimits());
+        score = result.score;
+        return result.cell;
+    }
+
+    // Deepens one ply at a time until the game is solved, the depth limit is
+    // reached or the budget runs out, and returns the best move found so far
+    SearchResult Search(Board board, const SearchLimits& limits) {
+        int helperCount = std::max(limits.threads, 1) - 1;
+        if (helperCount == 0) {
+            SearchResult result = RunIterations(board, limits, 0);
+            if (limits.stats) {
+                limits.stats->Add(m_counters);
+            }
+            return result;
+        }
+
+        // Helpers run until the main thread is done, whatever stopped it; only the main
+        // thread lists root moves and traces
+        std::atomic<bool> stopHelpers{false};
+        SearchLimits helperLimits = limits;
+        helperLimits.cancel = &stopHelpers;
+        helperLimits.stats = nullptr;
+        helperLimits.trace = nullptr;
+
+        std::vector<GameSearch> helpers(helperCount, GameSearch(m_table));
+        std::vector<std::thread> threads;
+        for (int i = 0; i < helperCount; i++) {
+            threads.emplace_back([&helpers, &helperLimits, board, i]() {
+                helpers[i].RunIterations(board, helperLimits, i + 1);
+            });
+        }
+
+        SearchResult result = RunIterations(board, limits, 0);
+
+        stopHelpers = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (const GameSearch& helper : helpers) {
+            result.nodes += helper.m_counters.nodes;
+            if (limits.stats) {
+                limits.stats->Add(helper.m_counters);
+            }
+        }
+        if (limits.stats) {
+            limits.stats->Add(m_counters);
+        }
+        return result;
+    }
+
+private:
+    // Check the clock and the cancel flag this often, in nodes
+    static constexpr uint64_t CLOCK_CHECK_INTERVAL = 1024;
+
+    // One thread's iterative deepening; threadIndex 0 is the main thread
+    SearchResult RunIterations(Board board, const SearchLimits& limits, int threadIndex) {
+        SearchResult result;
+        Mark toMove = board.ToMove();
+
+        m_counters = SearchCounters();
+        m_trace = limits.trace;
+        m_stopped = false;
+        m_hasDeadline = limits.budget.count() > 0;
+        m_deadline = std::chrono::steady_clock::now() + limits.budget;
+        m_cancel = limits.cancel;
+
+        if (board.HasWon(Opponent(toMove))) {
+            result.score = -(WIN_SCORE - board.MoveCount());
+            result.complete = true;
+            return result;
+        }
+
+        // Root moves in search order; each iteration tries the previous best first
+        std::array<int16_t, Board::CELLS> moves = {};
+        int moveCount = 0;
+        for (int cell = board.NextEmpty(0); cell >= 0; cell = board.NextEmpty(cell + 1)) {
+            moves[moveCount++] = (int16_t)cell;
+        }
+
+        if (moveCount == 0) {
+            result.complete = true;
+            return result;
+        }
+
+        int remaining = moveCount;
+        int maxDepth = (limits.maxDepth > 0) ? std::min(limits.maxDepth, remaining) : remaining;
+
+        // Root move entries in limits.stats by cell, added in the first iteration's order
+        std::array<RootMoveStats*, Board::CELLS> rootStats = {};
+        if (limits.stats) {
+            for (int i = 0; i < moveCount; i++) {
+                rootStats[moves[i]] = limits.stats->AddRootMove(moves[i]);
+            }
+        }
+
+        // Helpers begin at different root moves and depths
+        std::rotate(moves.begin(), moves.begin() + (threadIndex % moveCount), moves.begin() + moveCount);
+        int firstDepth = std::min(1 + (threadIndex & 1), maxDepth);
+
+        for (int depth = firstDepth; depth <= maxDepth; depth++) {
+            int bestScore = -WIN_SCORE - 1;
+            int bestIndex = -1;
+
+            m_iterationDepth = depth;
+
+            for (int i = 0; i < moveCount; i++) {
+                uint64_t nodesBefore = m_counters.nodes;
+                std::chrono::steady_clock::time_point moveStart;
+                if (limits.timeRootMoves) {
+                    moveStart = std::chrono::steady_clock::now();
+                }
+
+                board.Place(moves[i], toMove);
+                int value = -Negamax(board, Opponent(toMove), depth - 1, -WIN_SCORE - 1, -bestScore);
+                board.Undo(moves[i], toMove);
+
+                if (RootMoveStats* rootMove = rootStats[moves[i]]) {
+                    rootMove->nodes += m_counters.nodes - nodesBefore;
+                    if (limits.timeRootMoves) {
+                        rootMove->seconds +=
+                            std::chrono::duration<double>(std::chrono::steady_clock::now() - moveStart).count();
+                    }
+                    if (!m_stopped) {
+                        rootMove->score = value;
+                    }
+                }
+
+                if (m_stopped) {
+                    break;
+                }
+                SEARCH_TRACE(m_trace, RootMove, 0, moves[i], value);
+
+                if (value > bestScore) {
+                    bestScore = value;
+                    bestIndex = i;
+                }
+            }
+
+            // The previous best move is searched first, so even a cut-short iteration
+            // that finished any move has a result at least as good as the last one
+            if (bestIndex >= 0) {
+                result.cell = moves[bestIndex];
+                result.score = bestScore;
+            }
+
+            if (m_stopped) {
+                break;
+            }
+
+            // A proven result is final only once every line up to its length has been
+            // searched; a longer one may have come from the table while a quicker win exists
+            result.depth = depth;
+            SEARCH_TRACE(m_trace, Iteration, depth, result.cell, result.score);
+            result.complete = (depth == remaining) ||
+                (IsProvenScore(bestScore) && WIN_SCORE - std::abs(bestScore) - board.MoveCount() <= depth);
+
+            // Principal variation move leads the next iteration
+            std::rotate(moves.begin(), moves.begin() + bestIndex, moves.begin() + bestIndex + 1);
+
+            if (result.complete) {
+                break;
+            }
+        }
+
+        result.nodes = m_counters.nodes;
+        return result;
+    }
+
+    int Negamax(Board& board, Mark toMove, int depth, int alpha, int beta) {
+        int ply = m_iterationDepth - depth;
+        m_counters.nodes++;
+        m_counters.maxDepth = std::max(m_counters.maxDepth, ply);
+        SEARCH_TRACE(m_trace, Node, ply, -1, 0);
+        if ((m_counters.nodes % CLOCK_CHECK_INTERVAL) == 0) {
+            if ((m_hasDeadline && std::chrono::steady_clock::now() >= m_deadline) ||
+                (m_cancel && m_cancel->load(std::memory_order_relaxed))) {
+                m_stopped = true;
+            }
+        }
+        if (m_stopped) {
+            return 0;
+        }
+
+        // The previous move won, or the board filled up
+        if (board.HasWon(Opponent(toMove))) {
+            m_counters.leafEvaluations++;
+            SEARCH_TRACE(m_trace, Leaf, ply, -1, -(WIN_SCORE - board.MoveCount()));
+            return -(WIN_SCORE - board.MoveCount());
+        }
+        if (board.IsFull()) {
+            m_counters.leafEvaluations++;
+            SEARCH_TRACE(m_trace, Leaf, ply, -1, 0);
+            return 0;
+        }
+        if (depth == 0) {
+            m_counters.leafEvaluations++;
+            int score = EvaluatePosition(board, toMove);
+            SEARCH_TRACE(m_trace, Leaf, ply, -1, score);
+            return score;
+        }
+
+        uint64_t key = board.Hash();
+        int hashMove = -1;
+        TTEntry entry;
+        m_counters.tableProbes++;
+        if (m_table.Probe(key, entry)) {
+            m_counters.tableHits++;
+            SEARCH_TRACE(m_trace, TableHit, ply, entry.move, entry.score);
+            hashMove = entry.move;
+
+            if (entry.depth >= depth) {
+                if (entry.bound == Bound::Exact) {
+                    return entry.score;
+                } else if (entry.bound == Bound::Lower) {
+                    alpha = std::max(alpha, (int)entry.score);
+                } else if (entry.bound == Bound::Upper) {
+                    beta = std::min(beta, (int)entry.score);
+                }
+
+                if (beta <= alpha) {
+                    return entry.score;
+                }
+            }
+        }
+
+        int windowAlpha = alpha;
+        int bestScore = -WIN_SCORE - 1;
+        int bestMove = -1;
+
+        // The stored best move is searched first, then the rest in cell order
+        if (hashMove >= 0 && board.IsEmpty(hashMove)) {
+            board.Place(hashMove, toMove);
+            bestScore = -Negamax(board, Opponent(toMove), depth - 1, -beta, -alpha);
+            board.Undo(hashMove, toMove);
+            bestMove = hashMove;
+            alpha = std::max(alpha, bestScore);
+        } else {
+            hashMove = -1;
+        }
+
+        for (int cell = board.NextEmpty(0); cell >= 0 && alpha < beta; cell = board.NextEmpty(cell + 1)) {
+            if (cell == hashMove) {
+                continue;
+            }
+
+            board.Place(cell, toMove);
+            int value = -Negamax(board, Opponent(toMove), depth - 1, -beta, -alpha);
+            board.Undo(cell, toMove);
+
+            if (value > bestScore) {
+                bestScore = value;
+                bestMove = cell;
+            }
+            alpha = std::max(alpha, bestScore);
+        }
+
+        // Results of an interrupted search are not trustworthy
+        if (m_stopped) {
+            return 0;
+        }
+
+        // A score outside the window is only a bound on the true value
+        Bound bound = Bound::Exact;
+        if (bestScore <= windowAlpha) {
+            bound = Bound::Upper;
+        } else if (bestScore >= beta) {
+            bound = Bound::Lower;
+            m_counters.cutoffs++;
+            SEARCH_TRACE(m_trace, Cutoff, ply, bestMove, bestScore);
+        }
+        m_table.Store(key, bestScore, bound, depth, bestMove);
+
+        return bestScore;
+    }
+
+    TranspositionTable& m_table;
+    SearchCounters m_counters;
+    int m_iterationDepth = 0;                 // Depth of the running iteration, to give nodes their ply
+    SearchTraceSink* m_trace = nullptr;
+    bool m_stopped = false;
+    bool m_hasDeadline = false;
+    std::chrono::steady_clock::time_point m_deadline;
+    const std::atomic<bool>* m_cancel = nullptr;
+};
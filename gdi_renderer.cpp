@@ -0,0 +1,194 @@
+#include "gdi_renderer.h"
+#include <cstdlib>
+
+static COLORREF ToColorRef(Color color) {
+    return RGB(ColorRed(color), ColorGreen(color), ColorBlue(color));
+}
+
+static HFONT CreateUiFont(FontId font, int weight) {
+    #ifdef __GNUC__
+        return CreateFontA(FONT_HEIGHTS[(int)font], 0, 0, 0, weight, FALSE, FALSE, FALSE,
+                           DEFAULT_CHARSET, OUT_OUTLINE_PRECIS, CLIP_DEFAULT_PRECIS,
+                           CLEARTYPE_QUALITY, DEFAULT_PITCH | FF_SWISS, "Segoe UI");
+    #else
+        return CreateFontW(FONT_HEIGHTS[(int)font], 0, 0, 0, weight, FALSE, FALSE, FALSE,
+                           DEFAULT_CHARSET, OUT_OUTLINE_PRECIS, CLIP_DEFAULT_PRECIS,
+                           CLEARTYPE_QUALITY, DEFAULT_PITCH | FF_SWISS, L"Segoe UI");
+    #endif
+}
+
+// Single-line DrawText in the DC's current font and colour
+static void DrawLine(HDC hdc, const wchar_t* text, RECT rect, UINT format) {
+    #ifdef __GNUC__
+        char ansiText[256];
+        std::wcstombs(ansiText, text, sizeof(ansiText));
+        ansiText[sizeof(ansiText) - 1] = '\0';
+        DrawTextA(hdc, ansiText, -1, &rect, format | DT_VCENTER | DT_SINGLELINE);
+    #else
+        DrawTextW(hdc, text, -1, &rect, format | DT_VCENTER | DT_SINGLELINE);
+    #endif
+}
+
+GdiRenderer::GdiRenderer() {
+    // Create fonts for modern UI
+    m_fonts[(int)FontId::Title] = CreateUiFont(FontId::Title, FW_BOLD);
+    m_fonts[(int)FontId::Button] = CreateUiFont(FontId::Button, FW_SEMIBOLD);
+    m_fonts[(int)FontId::Game] = CreateUiFont(FontId::Game, FW_BOLD);
+    m_fonts[(int)FontId::Status] = CreateUiFont(FontId::Status, FW_MEDIUM);
+}
+
+GdiRenderer::~GdiRenderer() {
+    for (const Sprite& sprite : m_sprites) {
+        DeleteBitmapDC(sprite.dc, sprite.bitmap, sprite.oldBitmap);
+    }
+    if (m_overlayDC) {
+        DeleteBitmapDC(m_overlayDC, m_overlayBitmap, m_oldOverlayBitmap);
+    }
+    if (m_backDC) {
+        DeleteBitmapDC(m_backDC, m_backBitmap, m_oldBackBitmap);
+    }
+
+    for (HFONT font : m_fonts) {
+        DeleteObject(font);
+    }
+    for (const CachedBrush& cached : m_brushes) {
+        DeleteObject(cached.brush);
+    }
+    for (const CachedPen& cached : m_pens) {
+        DeleteObject(cached.pen);
+    }
+}
+
+HDC GdiRenderer::CreateBitmapDC(HDC reference, int width, int height, HBITMAP& bitmap, HGDIOBJ& oldBitmap) {
+    HDC dc = CreateCompatibleDC(reference);
+    bitmap = CreateCompatibleBitmap(reference, width, height);
+    oldBitmap = SelectObject(dc, bitmap);
+    SetBkMode(dc, TRANSPARENT);
+    return dc;
+}
+
+void GdiRenderer::DeleteBitmapDC(HDC dc, HBITMAP bitmap, HGDIOBJ oldBitmap) {
+    // The bitmap can only be deleted once it is no longer selected
+    SelectObject(dc, oldBitmap);
+    DeleteObject(bitmap);
+    DeleteDC(dc);
+}
+
+bool GdiRenderer::BeginFrame(HDC target, int width, int height) {
+    if (m_backDC && width == m_width && height == m_height) {
+        return false;
+    }
+
+    if (m_backDC) {
+        DeleteBitmapDC(m_backDC, m_backBitmap, m_oldBackBitmap);
+    }
+    m_backDC = CreateBitmapDC(target, width, height, m_backBitmap, m_oldBackBitmap);
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+void GdiRenderer::Present(HDC target, const RECT& area) {
+    BitBlt(target, area.left, area.top, area.right - area.left, area.bottom - area.top,
+           m_backDC, area.left, area.top, SRCCOPY);
+}
+
+void GdiRenderer::SetClip(const Rect& clip) {
+    // Drop the previous clip, then narrow to the new one without making a region object
+    SelectClipRgn(m_backDC, NULL);
+    IntersectClipRect(m_backDC, clip.left, clip.top, clip.right, clip.bottom);
+}
+
+HBRUSH GdiRenderer::Brush(Color color) {
+    for (const CachedBrush& cached : m_brushes) {
+        if (cached.color == color) {
+            return cached.brush;
+        }
+    }
+    m_brushes.push_back({color, CreateSolidBrush(ToColorRef(color))});
+    return m_brushes.back().brush;
+}
+
+HPEN GdiRenderer::Pen(Color color, int thickness) {
+    for (const CachedPen& cached : m_pens) {
+        if (cached.color == color && cached.thickness == thickness) {
+            return cached.pen;
+        }
+    }
+    m_pens.push_back({color, thickness, CreatePen(PS_SOLID, thickness, ToColorRef(color))});
+    return m_pens.back().pen;
+}
+
+void GdiRenderer::FillRect(const Rect& rect, Color color) {
+    RECT area = {rect.left, rect.top, rect.right, rect.bottom};
+    ::FillRect(m_backDC, &area, Brush(color));
+}
+
+void GdiRenderer::FrameRect(const Rect& rect, Color color, int thickness) {
+    if (thickness == 1) {
+        RECT area = {rect.left, rect.top, rect.right, rect.bottom};
+        ::FrameRect(m_backDC, &area, Brush(color));
+        return;
+    }
+
+    // A hollow rectangle outlined by a pen, which straddles the edge
+    SelectObject(m_backDC, Pen(color, thickness));
+    HGDIOBJ oldBrush = SelectObject(m_backDC, GetStockObject(NULL_BRUSH));
+    Rectangle(m_backDC, rect.left, rect.top, rect.right, rect.bottom);
+    SelectObject(m_backDC, oldBrush);
+}
+
+void GdiRenderer::Line(int x0, int y0, int x1, int y1, Color color, int thickness) {
+    SelectObject(m_backDC, Pen(color, thickness));
+    MoveToEx(m_backDC, x0, y0, NULL);
+    LineTo(m_backDC, x1, y1);
+}
+
+void GdiRenderer::Text(const Rect& rect, const wchar_t* text, FontId font, Color color, TextAlign align) {
+    SelectObject(m_backDC, m_fonts[(int)font]);
+    SetTextColor(m_backDC, ToColorRef(color));
+    DrawLine(m_backDC, text, {rect.left, rect.top, rect.right, rect.bottom},
+             (align == TextAlign::Center) ? DT_CENTER : DT_LEFT);
+}
+
+const GdiRenderer::Sprite& GdiRenderer::GlyphSprite(Glyph glyph, int width, int height, Color color,
+                                                     Color background) {
+    for (const Sprite& sprite : m_sprites) {
+        if (sprite.glyph == glyph && sprite.width == width && sprite.height == height && sprite.color == color &&
+            sprite.background == background) {
+            return sprite;
+        }
+    }
+
+    // The letter in the game font on the cell's background, ready to copy
+    Sprite sprite = {glyph, width, height, color, background, NULL, NULL, NULL};
+    sprite.dc = CreateBitmapDC(m_backDC, width, height, sprite.bitmap, sprite.oldBitmap);
+    RECT area = {0, 0, width, height};
+    ::FillRect(sprite.dc, &area, Brush(background));
+    SelectObject(sprite.dc, m_fonts[(int)FontId::Game]);
+    SetTextColor(sprite.dc, ToColorRef(color));
+    DrawLine(sprite.dc, (glyph == Glyph::X) ? L"X" : L"O", area, DT_CENTER);
+
+    m_sprites.push_back(sprite);
+    return m_sprites.back();
+}
+
+void GdiRenderer::DrawGlyph(const Rect& cell, Glyph glyph, Color color, Color background) {
+    const Sprite& sprite = GlyphSprite(glyph, cell.right - cell.left, cell.bottom - cell.top, color, background);
+    BitBlt(m_backDC, cell.left, cell.top, sprite.width, sprite.height, sprite.dc, 0, 0, SRCCOPY);
+}
+
+void GdiRenderer::Blend(const Rect& rect, Color color, uint8_t alpha) {
+    if (!m_overlayDC || color != m_overlayColor) {
+        if (!m_overlayDC) {
+            m_overlayDC = CreateBitmapDC(m_backDC, 1, 1, m_overlayBitmap, m_oldOverlayBitmap);
+        }
+        RECT pixel = {0, 0, 1, 1};
+        ::FillRect(m_overlayDC, &pixel, Brush(color));
+        m_overlayColor = color;
+    }
+
+    BLENDFUNCTION blend = {AC_SRC_OVER, 0, alpha, 0};
+    AlphaBlend(m_backDC, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top,
+               m_overlayDC, 0, 0, 1, 1, blend);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <windows.h>
+#include <array>
+#include <vector>
+#include "render.h"
+
+// Renderer drawing with GDI into a back buffer that is kept between frames and
+// copied to the window by Present. Fonts, brushes, pens, the X and O sprites and the
+// overlay source are made once and reused, so a frame creates no GDI objects.
+class GdiRenderer : public Renderer {
+public:
+    GdiRenderer();
+    ~GdiRenderer();
+
+    GdiRenderer(const GdiRenderer&) = delete;
+    GdiRenderer& operator=(const GdiRenderer&) = delete;
+
+    // Readies the back buffer for a frame of this size, recreating it only when the size
+    // changes; target is the window DC it will be copied to. Returns true when the buffer
+    // is new and the whole frame must be drawn.
+    bool BeginFrame(HDC target, int width, int height);
+
+    // Copies area of the back buffer to target
+    void Present(HDC target, const RECT& area);
+
+    void SetClip(const Rect& clip) override;
+    void FillRect(const Rect& rect, Color color) override;
+    void FrameRect(const Rect& rect, Color color, int thickness) override;
+    void Line(int x0, int y0, int x1, int y1, Color color, int thickness) override;
+    void Text(const Rect& rect, const wchar_t* text, FontId font, Color color, TextAlign align) override;
+    void DrawGlyph(const Rect& cell, Glyph glyph, Color color, Color background) override;
+    void Blend(const Rect& rect, Color color, uint8_t alpha) override;
+
+private:
+    struct CachedBrush {
+        Color color;
+        HBRUSH brush;
+    };
+
+    struct CachedPen {
+        Color color;
+        int thickness;
+        HPEN pen;
+    };
+
+    // Sprite of one glyph at one cell size and pair of colours, drawn on first use
+    struct Sprite {
+        Glyph glyph;
+        int width;
+        int height;
+        Color color;
+        Color background;
+        HDC dc;
+        HBITMAP bitmap;
+        HGDIOBJ oldBitmap;
+    };
+
+    HBRUSH Brush(Color color);
+    HPEN Pen(Color color, int thickness);
+    const Sprite& GlyphSprite(Glyph glyph, int width, int height, Color color, Color background);
+
+    // Off-screen DC holding a compatible bitmap of the given size
+    static HDC CreateBitmapDC(HDC reference, int width, int height, HBITMAP& bitmap, HGDIOBJ& oldBitmap);
+    static void DeleteBitmapDC(HDC dc, HBITMAP bitmap, HGDIOBJ oldBitmap);
+
+    HDC m_backDC = NULL;
+    HBITMAP m_backBitmap = NULL;
+    HGDIOBJ m_oldBackBitmap = NULL;
+    int m_width = 0;
+    int m_height = 0;
+
+    std::array<HFONT, 4> m_fonts;   // By FontId
+    std::vector<CachedBrush> m_brushes;
+    std::vector<CachedPen> m_pens;
+    std::vector<Sprite> m_sprites;
+
+    // One pixel of the overlay colour, stretched over the area Blend covers
+    HDC m_overlayDC = NULL;
+    HBITMAP m_overlayBitmap = NULL;
+    HGDIOBJ m_oldOverlayBitmap = NULL;
+    Color m_overlayColor = 0;
+};
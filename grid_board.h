@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "bitboard.h"
+
+// Deterministic 64-bit mixer used to generate Zobrist keys at compile time
+constexpr uint64_t SplitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Every run of K cells on an N x N board, and the runs passing through each cell
+template <int N, int K>
+struct LineTable {
+    static constexpr int RUNS_PER_ROW = N - K + 1;
+    static constexpr int WINDOWS = 2 * N * RUNS_PER_ROW + 2 * RUNS_PER_ROW * RUNS_PER_ROW;
+    static constexpr int MAX_PER_CELL = 4 * K;
+
+    std::array<std::array<int16_t, K>, WINDOWS> windowCells = {};
+    std::array<std::array<int16_t, MAX_PER_CELL>, N * N> cellWindows = {};
+    std::array<uint8_t, N * N> cellWindowCount = {};
+    std::array<std::array<uint64_t, 2>, N * N> zobrist = {};
+};
+
+template <int N, int K>
+constexpr LineTable<N, K> BuildLineTable() {
+    LineTable<N, K> table = {};
+
+    // Directions: right, down, down-right, down-left
+    constexpr int dRow[4] = {0, 1, 1, 1};
+    constexpr int dCol[4] = {1, 0, 1, -1};
+
+    int window = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        for (int row = 0; row < N; row++) {
+            for (int col = 0; col < N; col++) {
+                int endRow = row + dRow[dir] * (K - 1);
+                int endCol = col + dCol[dir] * (K - 1);
+                if (endRow < 0 || endRow >= N || endCol < 0 || endCol >= N) {
+                    continue;
+                }
+
+                for (int i = 0; i < K; i++) {
+                    int cell = (row + dRow[dir] * i) * N + (col + dCol[dir] * i);
+                    table.windowCells[window][i] = (int16_t)cell;
+                    table.cellWindows[cell][table.cellWindowCount[cell]++] = (int16_t)window;
+                }
+                window++;
+            }
+        }
+    }
+
+    uint64_t seed = 0x5851F42D4C957F2Dull ^ (uint64_t(N) << 32) ^ uint64_t(K);
+    for (int cell = 0; cell < N * N; cell++) {
+        table.zobrist[cell][0] = SplitMix64(seed);
+        table.zobrist[cell][1] = SplitMix64(seed);
+    }
+    return table;
+}
+
+// N x N board won by K in a row. Each move updates the stone counts of the runs
+// through its cell, so win detection never rescans the board.
+template <int N, int K>
+class GridBoard {
+public:
+    static_assert(K >= 2 && K <= N, "run length must fit on the board");
+    static_assert(N * N <= 32767, "cell indices are stored as int16_t");
+
+    static constexpr int SIZE = N;
+    static constexpr int WIN_LENGTH = K;
+    static constexpr int CELLS = N * N;
+    static constexpr LineTable<N, K> LINES = BuildLineTable<N, K>();
+
+    bool IsEmpty(int cell) const { return m_cells[cell] == 0; }
+    bool Has(int cell, Mark mark) const { return m_cells[cell] == Stone(mark); }
+    bool HasWon(Mark mark) const { return m_completeLines[(int)mark] > 0; }
+    bool IsFull() const { return m_moves == CELLS; }
+    int MoveCount() const { return m_moves; }
+
+    // Side to move, assuming X always starts
+    Mark ToMove() const { return (m_moves & 1) ? Mark::O : Mark::X; }
+
+    // Zobrist hash of the stones on the board
+    uint64_t Hash() const { return m_hash; }
+
+    // Stones of the given side inside a run; a run holding both sides is dead
+    int LineCount(int window, Mark mark) const { return m_lineCounts[(int)mark][window]; }
+
+    // First empty cell at or after from, or -1
+    int NextEmpty(int from) const {
+        for (int cell = from; cell < CELLS; cell++) {
+            if (m_cells[cell] == 0) {
+                return cell;
+            }
+        }
+        return -1;
+    }
+
+    void Place(int cell, Mark mark) {
+        int side = (int)mark;
+        m_cells[cell] = Stone(mark);
+        m_moves++;
+        m_hash ^= LINES.zobrist[cell][side];
+
+        for (int i = 0; i < LINES.cellWindowCount[cell]; i++) {
+            int window = LINES.cellWindows[cell][i];
+            if (++m_lineCounts[side][window] == K) {
+                m_completeLines[side]++;
+            }
+        }
+    }
+
+    // Takes back a stone placed by Place
+    void Undo(int cell, Mark mark) {
+        int side = (int)mark;
+        m_cells[cell] = 0;
+        m_moves--;
+        m_hash ^= LINES.zobrist[cell][side];
+
+        for (int i = 0; i < LINES.cellWindowCount[cell]; i++) {
+            int window = LINES.cellWindows[cell][i];
+            if (m_lineCounts[side][window]-- == K) {
+                m_completeLines[side]--;
+            }
+        }
+    }
+
+    // Same stones on the same cells; the line counts and hash follow from them
+    bool operator==(const GridBoard& other) const { return m_cells == other.m_cells; }
+    bool operator!=(const GridBoard& other) const { return !(*this == other); }
+
+private:
+    static constexpr uint8_t Stone(Mark mark) { return mark == Mark::X ? 1 : 2; }
+
+    std::array<uint8_t, CELLS> m_cells = {};
+    std::array<std::array<uint8_t, LineTable<N, K>::WINDOWS>, 2> m_lineCounts = {};
+    std::array<int, 2> m_completeLines = {};
+    int m_moves = 0;
+    uint64_t m_hash = 0;
+};
+
+// Board type for a given size and run length: the bitboard is the fast path for 3x3
+template <int N, int K>
+struct BoardSelector {
+    using Type = GridBoard<N, K>;
+};
+
+template <>
+struct BoardSelector<3, 3> {
+    using Type = Bitboard;
+};
+
+template <int N, int K>
+using BoardFor = typename BoardSelector<N, K>::Type;
@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <typeinfo>
+#include "grid_board.h"
+#include "node_pool.h"
+
+// One position in the Monte Carlo tree, reached by playing move. Children are
+// allocated together, so a node only needs the index of its first child.
+struct MctsNode {
+    uint32_t firstChild = NodePool<MctsNode>::NONE;
+    uint32_t visits = 0;
+    float reward = 0.0f;        // Summed playout results for the side that played move: 1 win, 0.5 draw
+    int16_t move = -1;
+    uint16_t childCount = 0;
+};
+
+struct MctsLimits {
+    uint64_t playouts = 0;                          // Root visits to reach, counting reused ones; 0 means no limit
+    std::chrono::milliseconds budget{0};            // Wall-clock budget; 0 means no limit
+    const std::atomic<bool>* cancel = nullptr;      // Stops the search early when set
+};
+
+struct MctsResult {
+    int cell = -1;              // Most visited move for the side to move, -1 if the game is over
+    uint64_t playouts = 0;      // Playouts run by this search
+    uint64_t reusedVisits = 0;  // Root visits carried over from the previous search's tree
+    size_t reusedNodes = 0;     // Nodes carried over with them
+    size_t nodes = 0;           // Tree nodes in use when the search ended
+    double seconds = 0.0;
+    bool poolFull = false;      // The tree stopped growing; later playouts started from its leaves
+    
+    double PlayoutsPerSecond() const { return seconds > 0.0 ? playouts / seconds : 0.0; }
+};
+
+// Key of a board's stones, to recognise the root of a kept tree: exact on 3x3, and
+// the Zobrist hash the transposition table already trusts on larger boards
+inline uint64_t MctsPositionKey(const Bitboard& board) { return board.Key(); }
+
+template <int N, int K>
+uint64_t MctsPositionKey(const GridBoard<N, K>& board) { return board.Hash(); }
+
+// The Monte Carlo tree kept between searches: one node pool and the position at
+// its root. It is not tied to a board type, so a player keeps the same pool
+// whatever it plays on, and a search on another board type starts a new tree in it.
+class MctsTree {
+public:
+    explicit MctsTree(size_t nodeLimit) : m_pool(nodeLimit) {}
+    
+    size_t NodeLimit() const { return m_pool.Capacity(); }
+    
+    // Forgets the tree, e.g. when a new game starts
+    void Clear() {
+        m_pool.Reset();
+        m_rootIndex = NodePool<MctsNode>::NONE;
+    }
+    
+    // Bytes held by the node pool
+    ArenaStats MemoryStats() const { return m_pool.Stats(); }
+    
+private:
+    template <typename Board>
+    friend class MctsSearch;
+    
+    NodePool<MctsNode> m_pool;
+    uint32_t m_rootIndex = NodePool<MctsNode>::NONE;
+    const std::type_info* m_rootType = nullptr;     // Board type of the root position
+    uint64_t m_rootKey = 0;
+    int m_rootMoves = 0;
+};
+
+// UCT search over any board with the GridBoard interface, with uniformly random
+// playouts, growing the tree it is given. Tree nodes come from the tree's fixed-size
+// NodePool, which bounds memory: once it is full the tree stops growing and the
+// search keeps refining the statistics it has. Without a playout or time limit it
+// runs until cancelled.
+//
+// The tree outlives a search. When the next search starts from a position one or
+// two moves below the last root (typically after our move and the reply), that
+// subtree is moved to the front of the pool and the rest released, so its playouts
+// count towards the next move without a second pool.
+template <typename Board>
+class MctsSearch {
+public:
+    // Child counts leave two bits for marking nodes while the pool is compacted
+    static_assert(Board::CELLS < 0x4000, "child counts must leave room for the compaction flags");
+    
+    explicit MctsSearch(MctsTree& tree) : m_tree(tree), m_pool(tree.m_pool) {}
+    
+    MctsResult Search(const Board& root, const MctsLimits& limits, uint64_t seed) {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        Clock::time_point deadline = start + limits.budget;
+        bool hasDeadline = limits.budget.count() > 0;
+        
+        MctsResult result;
+        m_random = seed;
+        m_poolFull = false;
+        
+        Mark rootToMove = root.ToMove();
+        if (root.HasWon(Opponent(rootToMove)) || root.IsFull()) {
+            m_tree.Clear();
+            return result;
+        }
+        
+        // Keep the part of the last tree below this position, or start a new one
+        uint32_t rootIndex = ReuseSubtree(root);
+        if (rootIndex == NodePool<MctsNode>::NONE) {
+            m_pool.Reset();
+            rootIndex = m_pool.Allocate(1);
+        } else {
+            result.reusedVisits = m_pool[rootIndex].visits;
+            result.reusedNodes = m_pool.Used();
+        }
+        m_tree.m_rootIndex = rootIndex;
+        m_tree.m_rootType = &typeid(Board);
+        m_tree.m_rootKey = MctsPositionKey(root);
+        m_tree.m_rootMoves = root.MoveCount();
+        
+        // A pool too small for the root's children still owes the caller a legal move
+        if (m_pool[rootIndex].childCount == 0 && !Expand(rootIndex, root)) {
+            int pick = (int)(SplitMix64(m_random) % (uint64_t)(Board::CELLS - root.MoveCount()));
+            for (result.cell = root.NextEmpty(0); pick > 0; pick--) {
+                result.cell = root.NextEmpty(result.cell + 1);
+            }
+            result.nodes = m_pool.Used();
+            result.poolFull = true;
+            result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            return result;
+        }
+        
+        // Nodes from the root down to the leaf of the current iteration
+        std::array<uint32_t, Board::CELLS + 1> path = {};
+        
+        while (limits.playouts == 0 || m_pool[rootIndex].visits < limits.playouts) {
+            if ((result.playouts % CLOCK_CHECK_INTERVAL) == 0 && result.playouts > 0) {
+                if ((hasDeadline && Clock::now() >= deadline) ||
+                    (limits.cancel && limits.cancel->load(std::memory_order_relaxed))) {
+                    break;
+                }
+            }
+            
+            // Selection: descend by UCT until a node with no children
+            Board board = root;
+            Mark toMove = rootToMove;
+            int depth = 0;
+            uint32_t node = rootIndex;
+            path[depth] = node;
+            
+            int winner = NO_WINNER;
+            bool finished = false;
+            while (true) {
+                if (board.HasWon(Opponent(toMove))) {
+                    winner = (int)Opponent(toMove);
+                    finished = true;
+                    break;
+                }
+                if (board.IsFull()) {
+                    finished = true;
+                    break;
+                }
+                
+                // Expansion: a leaf seen before gets its children
+                if (m_pool[node].childCount == 0) {
+                    if (m_pool[node].visits == 0 || !Expand(node, board)) {
+                        break;
+                    }
+                }
+                
+                node = SelectChild(node);
+                board.Place(m_pool[node].move, toMove);
+                toMove = Opponent(toMove);
+                path[++depth] = node;
+            }
+            
+            // Simulation, then backpropagation along the path
+            if (!finished) {
+                winner = Playout(board, toMove);
+            }
+            
+            for (int d = depth; d >= 0; d--) {
+                MctsNode& visited = m_pool[path[d]];
+                visited.visits++;
+                
+                // The node at odd depths was reached by a move of the side to move at the root
+                Mark mover = (d & 1) ? rootToMove : Opponent(rootToMove);
+                if (winner == NO_WINNER) {
+                    visited.reward += 0.5f;
+                } else if (winner == (int)mover) {
+                    visited.reward += 1.0f;
+                }
+            }
+            
+            result.playouts++;
+        }
+        
+        // The most visited move is the most trusted one
+        const MctsNode& rootNode = m_pool[rootIndex];
+        uint32_t bestVisits = 0;
+        for (uint32_t i = 0; i < rootNode.childCount; i++) {
+            const MctsNode& child = m_pool[rootNode.firstChild + i];
+            if (result.cell < 0 || child.visits > bestVisits) {
+                bestVisits = child.visits;
+                result.cell = child.move;
+            }
+        }
+        
+        result.nodes = m_pool.Used();
+        result.poolFull = m_poolFull;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+
+private:
+    static constexpr int NO_WINNER = -1;
+    static constexpr uint64_t CLOCK_CHECK_INTERVAL = 64;
+    
+    // Exploration weight of the UCT bound; rewards lie in [0, 1]
+    static constexpr float EXPLORATION = 1.4f;
+    
+    // childCount flags used only while CompactToFront runs
+    static constexpr uint16_t KEPT = 0x8000;
+    static constexpr uint16_t BLOCK_START = 0x4000;
+    static constexpr uint16_t CHILD_COUNT = 0x3fff;
+    
+    // Index of the node for root in the last tree, moved to the front of the pool with
+    // everything below it, or NONE if root is not at most two moves below the last root
+    uint32_t ReuseSubtree(const Board& root) {
+        if (m_tree.m_rootIndex == NodePool<MctsNode>::NONE || *m_tree.m_rootType != typeid(Board)) {
+            return NodePool<MctsNode>::NONE;
+        }
+        
+        int plies = root.MoveCount() - m_tree.m_rootMoves;
+        if (plies < 0 || plies > 2) {
+            return NodePool<MctsNode>::NONE;
+        }
+        
+        // Follow the children whose moves are on the new board, then make sure taking
+        // them back gives the last root
+        Board earlier = root;
+        Mark toMove = (plies & 1) ? Opponent(root.ToMove()) : root.ToMove();
+        uint32_t node = m_tree.m_rootIndex;
+        for (int ply = 0; ply < plies; ply++) {
+            const MctsNode& parent = m_pool[node];
+            uint32_t next = NodePool<MctsNode>::NONE;
+            for (uint32_t i = 0; i < parent.childCount; i++) {
+                if (root.Has(m_pool[parent.firstChild + i].move, toMove)) {
+                    next = parent.firstChild + i;
+                    break;
+                }
+            }
+            if (next == NodePool<MctsNode>::NONE) {
+                return NodePool<MctsNode>::NONE;
+            }
+            
+            earlier.Undo(m_pool[next].move, toMove);
+            toMove = Opponent(toMove);
+            node = next;
+        }
+        if (MctsPositionKey(earlier) != m_tree.m_rootKey) {
+            return NodePool<MctsNode>::NONE;
+        }
+        
+        // The root is always node 0, so the same position again keeps the whole pool
+        if (node == 0) {
+            return 0;
+        }
+        return CopyToFront(node) ? 0 : CompactToFront(node);
+    }
+    
+    // Copies the subtree under node breadth-first into the free end of the pool, then
+    // slides the copy down to index 0. The copies double as the queue, each holding its
+    // old first-child index until its children are copied. False, with the pool as it
+    // was, if the free end cannot hold the subtree.
+    bool CopyToFront(uint32_t node) {
+        uint32_t used = (uint32_t)m_pool.Used();
+        uint32_t copyRoot = m_pool.Allocate(1);
+        if (copyRoot == NodePool<MctsNode>::NONE) {
+            return false;
+        }
+        
+        m_pool[copyRoot] = m_pool[node];
+        for (uint32_t index = copyRoot; index < m_pool.Used(); index++) {
+            MctsNode& copy = m_pool[index];
+            if (copy.childCount == 0) {
+                continue;
+            }
+            
+            uint32_t first = m_pool.Allocate(copy.childCount);
+            if (first == NodePool<MctsNode>::NONE) {
+                m_pool.Truncate(used);
+                return false;
+            }
+            for (uint32_t i = 0; i < copy.childCount; i++) {
+                m_pool[first + i] = m_pool[copy.firstChild + i];
+            }
+            copy.firstChild = first;
+        }
+        
+        // The copy lies above every node it replaces, so moving it down in index order
+        // never overwrites a node still to be moved
+        uint32_t count = (uint32_t)m_pool.Used() - copyRoot;
+        for (uint32_t i = 0; i < count; i++) {
+            MctsNode moved = m_pool[copyRoot + i];
+            if (moved.childCount > 0) {
+                moved.firstChild -= copyRoot;
+            }
+            m_pool[i] = moved;
+        }
+        m_pool.Truncate(count);
+        return true;
+    }
+    
+    // Slides the subtree under node down to index 0 in place, for when the pool is too
+    // full to copy it; returns the new index, 0. Children always sit after their parent,
+    // so in index order each kept node moves to a slot that is free or already moved.
+    // Parents mark their child blocks as kept when they move. Until a block moves, its
+    // first node holds the parent's new index and the moved parent holds the first
+    // node's own child link, so the parent can be pointed at the block's new place.
+    uint32_t CompactToFront(uint32_t node) {
+        uint32_t used = (uint32_t)m_pool.Used();
+        uint32_t next = 0;
+        m_pool[node].childCount |= KEPT;
+        
+        for (uint32_t index = node; index < used; index++) {
+            MctsNode moved = m_pool[index];
+            if (!(moved.childCount & KEPT)) {
+                continue;
+            }
+            
+            if (moved.childCount & BLOCK_START) {
+                MctsNode& parent = m_pool[moved.firstChild];
+                moved.firstChild = parent.firstChild;
+                parent.firstChild = next;
+            }
+            moved.childCount &= CHILD_COUNT;
+            
+            if (moved.childCount > 0) {
+                for (uint32_t i = 0; i < moved.childCount; i++) {
+                    m_pool[moved.firstChild + i].childCount |= KEPT;
+                }
+                MctsNode& first = m_pool[moved.firstChild];
+                first.childCount |= BLOCK_START;
+                uint32_t link = first.firstChild;
+                first.firstChild = next;
+                moved.firstChild = link;
+            }
+            m_pool[next++] = moved;
+        }
+        
+        m_pool.Truncate(next);
+        return 0;
+    }
+    
+    // Gives node one child per empty cell; false if the pool has no room left
+    bool Expand(uint32_t node, const Board& board) {
+        uint32_t count = (uint32_t)(Board::CELLS - board.MoveCount());
+        uint32_t first = m_pool.Allocate(count);
+        if (first == NodePool<MctsNode>::NONE) {
+            m_poolFull = true;
+            return false;
+        }
+        
+        uint32_t child = first;
+        for (int cell = board.NextEmpty(0); cell >= 0; cell = board.NextEmpty(cell + 1)) {
+            m_pool[child++].move = (int16_t)cell;
+        }
+        m_pool[node].firstChild = first;
+        m_pool[node].childCount = (uint16_t)count;
+        return true;
+    }
+    
+    // Unvisited children first, then the highest upper confidence bound
+    uint32_t SelectChild(uint32_t node) {
+        const MctsNode& parent = m_pool[node];
+        float logVisits = std::log((float)parent.visits);
+        uint32_t best = parent.firstChild;
+        float bestValue = -1.0f;
+        
+        for (uint32_t i = 0; i < parent.childCount; i++) {
+            uint32_t index = parent.firstChild + i;
+            const MctsNode& child = m_pool[index];
+            if (child.visits == 0) {
+                return index;
+            }
+            
+            float value = child.reward / child.visits + EXPLORATION * std::sqrt(logVisits / child.visits);
+            if (value > bestValue) {
+                bestValue = value;
+                best = index;
+            }
+        }
+        return best;
+    }
+    
+    // Plays uniformly random moves to the end of the game; returns the winner as
+    // (int)Mark, or NO_WINNER for a draw
+    int Playout(Board board, Mark toMove) {
+        std::array<int16_t, Board::CELLS> empty;
+        int count = 0;
+        for (int cell = board.NextEmpty(0); cell >= 0; cell = board.NextEmpty(cell + 1)) {
+            empty[count++] = (int16_t)cell;
+        }
+        
+        // Partial Fisher-Yates shuffle, drawing each move as it is needed
+        for (int i = 0; i < count; i++) {
+            int pick = i + (int)(SplitMix64(m_random) % (uint64_t)(count - i));
+            std::swap(empty[i], empty[pick]);
+            
+            board.Place(empty[i], toMove);
+            if (board.HasWon(toMove)) {
+                return (int)toMove;
+            }
+            toMove = Opponent(toMove);
+        }
+        return NO_WINNER;
+    }
+    
+    MctsTree& m_tree;
+    NodePool<MctsNode>& m_pool;
+    uint64_t m_random = 0;
+    bool m_poolFull = false;
+};
@@ -0,0 +1,36 @@
+#include "move_list.h"
+
+const char* ParseMoveListLine(const char* begin, const char* end, GameRecord& record, MoveListLine& kind) {
+    record.Clear();
+    kind = MoveListLine::Blank;
+    
+    const char* cursor = begin;
+    bool comment = false;
+    for (; cursor < end && *cursor != '\n'; cursor++) {
+        char c = *cursor;
+        if (comment || c == ' ' || c == '\t' || c == ',' || c == '\r') {
+            continue;
+        }
+        
+        if (c == '#') {
+            comment = true;
+        } else if (c >= '0' && c <= '8' && kind != MoveListLine::Invalid && record.moveCount < BOARD_CELLS) {
+            record.Add(c - '0');
+            kind = MoveListLine::Game;
+        } else {
+            kind = MoveListLine::Invalid;
+        }
+    }
+    
+    return (cursor < end) ? cursor + 1 : end;
+}
+
+void AppendMoveListLine(const GameRecord& record, std::string& out) {
+    for (int i = 0; i < record.moveCount; i++) {
+        if (i > 0) {
+            out += ' ';
+        }
+        out += (char)('0' + record.moves[i]);
+    }
+    out += '\n';
+}
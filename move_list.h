@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include "game_record.h"
+
+// Move-list game logs: plain text, one 3x3 game per line, for files written by hand
+// or by other programs.
+//
+//   - A game is the cells played in order, X first, as digits 0-8 numbered row by
+//     row from the top left (row * 3 + col).
+//   - Spaces, tabs, commas and a trailing '\r' between digits are ignored.
+//   - '#' starts a comment that runs to the end of the line.
+//   - Lines with no moves are skipped.
+//   - A game may stop before it is decided.
+//   - The result is not stored; readers replay the moves to find it.
+//
+// For example, "4 0 8 2 1 7 6 3 5" is a draw and "0 3 1 4 2" a win for X.
+enum class MoveListLine { Game, Blank, Invalid };
+
+// Parses the line starting at begin, reading no further than end. On Game, record
+// holds its moves with result Playing. Returns the start of the next line.
+const char* ParseMoveListLine(const char* begin, const char* end, GameRecord& record, MoveListLine& kind);
+
+// Appends the game as one line, moves separated by spaces
+void AppendMoveListLine(const GameRecord& record, std::string& out);
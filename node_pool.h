@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "arena.h"
+
+// Fixed-capacity pool handing out runs of consecutive T by index, carved from an
+// arena of exactly capacity nodes. Reset releases every node at once, so a search
+// using it never touches the heap and its memory has a hard ceiling.
+template <typename T>
+class NodePool {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    
+    explicit NodePool(size_t capacity) : m_arena((capacity < NONE ? capacity : NONE - 1) * sizeof(T)) {}
+    
+    // First index of count fresh nodes, or NONE if the pool cannot hold them
+    uint32_t Allocate(uint32_t count) {
+        T* first = m_arena.Allocate<T>(count);
+        return first ? (uint32_t)(first - Nodes()) : NONE;
+    }
+    
+    void Reset() { m_arena.Reset(); }
+    
+    // Keeps the first count nodes and releases the rest
+    void Truncate(size_t count) { m_arena.Rewind(count * sizeof(T)); }
+    void ResetPeak() { m_arena.ResetPeak(); }
+    
+    T& operator[](uint32_t index) { return Nodes()[index]; }
+    const T& operator[](uint32_t index) const { return Nodes()[index]; }
+    
+    size_t Used() const { return m_arena.Used() / sizeof(T); }
+    size_t Peak() const { return m_arena.Stats().peak / sizeof(T); }
+    size_t Capacity() const { return m_arena.Capacity() / sizeof(T); }
+    size_t Bytes() const { return m_arena.Capacity(); }
+    ArenaStats Stats() const { return m_arena.Stats(); }
+    
+private:
+    T* Nodes() { return reinterpret_cast<T*>(m_arena.Data()); }
+    const T* Nodes() const { return reinterpret_cast<const T*>(m_arena.Data()); }
+    
+    Arena m_arena;
+};
@@ -0,0 +1,77 @@
+#include "opening_book.h"
+#include <algorithm>
+#include <cstdio>
+
+bool WriteOpeningBook(const std::string& path, int size, int winLength, std::vector<BookEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.hash < b.hash;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.hash == b.hash;
+    }), entries.end());
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    BookHeader header;
+    header.size = (uint16_t)size;
+    header.winLength = (uint16_t)winLength;
+    header.count = entries.size();
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (const BookEntry& entry : entries) {
+        ok = ok && std::fwrite(&entry.hash, sizeof(entry.hash), 1, file) == 1;
+    }
+    for (const BookEntry& entry : entries) {
+        ok = ok && std::fwrite(&entry.record, sizeof(entry.record), 1, file) == 1;
+    }
+
+    return (std::fclose(file) == 0) && ok;
+}
+
+bool OpeningBook::Open(const std::string& path) {
+    Close();
+
+    // Lookups jump around the key array, so read-ahead would only fetch pages never used
+    if (!m_file.Open(path, MappedFile::Access::Random)) {
+        return false;
+    }
+
+    // Only the header is read here; the entries stay on disk until looked up
+    const uint8_t* data = m_file.Data();
+    size_t bytes = m_file.Size();
+    const BookHeader* header = reinterpret_cast<const BookHeader*>(data);
+    if (bytes < sizeof(BookHeader) || header->magic != BOOK_MAGIC || header->version != BOOK_VERSION ||
+        header->count > (bytes - sizeof(BookHeader)) / (sizeof(uint64_t) + sizeof(BookRecord)) ||
+        sizeof(BookHeader) + header->count * (sizeof(uint64_t) + sizeof(BookRecord)) != bytes) {
+        Close();
+        return false;
+    }
+
+    m_count = header->count;
+    m_size = header->size;
+    m_winLength = header->winLength;
+    m_hashes = reinterpret_cast<const uint64_t*>(data + sizeof(BookHeader));
+    m_records = reinterpret_cast<const BookRecord*>(data + sizeof(BookHeader) + m_count * sizeof(uint64_t));
+    return true;
+}
+
+void OpeningBook::Close() {
+    m_file.Close();
+    m_hashes = nullptr;
+    m_records = nullptr;
+    m_count = 0;
+    m_size = 0;
+    m_winLength = 0;
+}
+
+const BookRecord* OpeningBook::Find(uint64_t hash) const {
+    const uint64_t* end = m_hashes + m_count;
+    const uint64_t* found = std::lower_bound(m_hashes, end, hash);
+    if (found == end || *found != hash) {
+        return nullptr;
+    }
+    return &m_records[found - m_hashes];
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+// Book file layout, little-endian:
+//
+//   BookHeader
+//   uint64_t   hashes[count]     ascending
+//   BookRecord records[count]    records[i] belongs to hashes[i]
+//
+// Hashes are GridBoard<size, winLength>::Hash() of each stored position. Keeping
+// them apart from the records means a lookup binary searches a dense array of
+// keys and then reads a single record.
+constexpr uint32_t BOOK_MAGIC = 0x4B424F58;     // "XOBK"
+constexpr uint32_t BOOK_VERSION = 1;
+
+struct BookHeader {
+    uint32_t magic = BOOK_MAGIC;
+    uint32_t version = BOOK_VERSION;
+    uint16_t size = 0;          // Board is size x size
+    uint16_t winLength = 0;     // Stones in a row that win
+    uint32_t reserved = 0;
+    uint64_t count = 0;         // Positions stored
+};
+
+static_assert(sizeof(BookHeader) == 24, "book header layout is part of the file format");
+
+struct BookRecord {
+    int16_t cell;       // Best move for the side to move, row * size + col
+    int16_t score;      // Its search score for the side to move
+    uint8_t depth;      // Plies fully searched
+    uint8_t exact;      // 1 if the score is the value under perfect play
+};
+
+static_assert(sizeof(BookRecord) == 6, "book record layout is part of the file format");
+
+struct BookEntry {
+    uint64_t hash;
+    BookRecord record;
+};
+
+// Writes entries as a book for size x size boards won by winLength in a row. Entries
+// are sorted by hash and duplicate hashes are dropped. Returns false if the file
+// cannot be written.
+bool WriteOpeningBook(const std::string& path, int size, int winLength, std::vector<BookEntry> entries);
+
+// Read-only view of a book file mapped into memory. Opening only checks the header
+// and the file length, so it takes the same time for any book size; lookups read
+// the mapping in place and the OS pages in only the parts they touch.
+class OpeningBook {
+public:
+    // Maps the file, replacing any book already open; false if it is missing or malformed
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_file.IsOpen(); }
+
+    // True if the open book was built for this board size and run length
+    bool Covers(int size, int winLength) const {
+        return IsOpen() && m_size == size && m_winLength == winLength;
+    }
+
+    uint64_t Count() const { return m_count; }
+
+    // Record for a position's hash, or nullptr if the book does not hold it
+    const BookRecord* Find(uint64_t hash) const;
+
+private:
+    MappedFile m_file;
+    const uint64_t* m_hashes = nullptr;
+    const BookRecord* m_records = nullptr;
+    uint64_t m_count = 0;
+    int m_size = 0;
+    int m_winLength = 0;
+};
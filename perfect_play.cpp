@@ -0,0 +1,68 @@
+#include "perfect_play.h"
+#include <array>
+
+using PerfectPlayTable = std::array<PerfectPlayEntry, POSITION_KEYS>;
+
+// Marks a table slot whose position has not been solved yet
+static constexpr int8_t UNSOLVED = -2;
+
+// Negamax over reachable positions, memoized in the table by base-3 key; scored like AIPlayer::Minimax
+static constexpr int8_t SolvePosition(PerfectPlayTable& table, Bitboard board, Mark toMove) {
+    PerfectPlayEntry& entry = table[board.Key()];
+    if (entry.cell != UNSOLVED) {
+        return entry.value;
+    }
+    
+    // The previous move won, or the board filled up
+    if (board.HasWon(Opponent(toMove))) {
+        entry = {-1, (int8_t)(-10 - (BOARD_CELLS - board.MoveCount()))};
+        return entry.value;
+    }
+    if (board.IsFull()) {
+        entry = {-1, 0};
+        return entry.value;
+    }
+    
+    int8_t bestValue = -100;
+    int8_t bestCell = -1;
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        if (board.IsEmpty(cell)) {
+            int8_t value = -SolvePosition(table, board.Play(cell, toMove), Opponent(toMove));
+            if (value > bestValue) {
+                bestValue = value;
+                bestCell = (int8_t)cell;
+            }
+        }
+    }
+    
+    entry = {bestCell, bestValue};
+    return bestValue;
+}
+
+static constexpr PerfectPlayTable BuildPerfectPlayTable() {
+    PerfectPlayTable table = {};
+    for (PerfectPlayEntry& entry : table) {
+        entry.cell = UNSOLVED;
+    }
+    
+    SolvePosition(table, Bitboard{}, Mark::X);
+    
+    // Positions never reached from the empty board have no move
+    for (PerfectPlayEntry& entry : table) {
+        if (entry.cell == UNSOLVED) {
+            entry = {-1, 0};
+        }
+    }
+    return table;
+}
+
+// Solved at compile time; MSVC needs a raised /constexpr:steps limit for this (set in XOGame.vcxproj)
+static constexpr PerfectPlayTable PERFECT_PLAY_TABLE = BuildPerfectPlayTable();
+
+// Tic-tac-toe is a draw, and X's first perfect move is the top-left corner in row-major tie order
+static_assert(PERFECT_PLAY_TABLE[0].value == 0, "empty board must be a draw");
+static_assert(PERFECT_PLAY_TABLE[0].cell == 0, "first optimal move from the empty board is cell 0");
+
+const PerfectPlayEntry& LookupPerfectPlay(const Bitboard& board) {
+    return PERFECT_PLAY_TABLE[board.Key()];
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include "bitboard.h"
+
+// Solved result for one 3x3 position, from the point of view of the side to move
+struct PerfectPlayEntry {
+    int8_t cell = -1;   // Best cell (first in row-major order among equals), -1 if the game is over or unreachable
+    int8_t value = 0;   // Minimax score with perfect play: 10 + empty cells left for a win, negated for a loss, 0 for a draw
+};
+
+// Looks up the compiled-in solution for a position reached with X moving first
+const PerfectPlayEntry& LookupPerfectPlay(const Bitboard& board);
@@ -0,0 +1,187 @@
+#include "pixel_renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+void PixelRenderer::Resize(int width, int height) {
+    m_clip = {0, 0, width, height};
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_pixels.assign((size_t)m_width * m_height, 0);
+}
+
+void PixelRenderer::SetClip(const Rect& clip) {
+    m_clip = clip;
+}
+
+uint64_t PixelRenderer::Checksum() const {
+    uint64_t hash = 14695981039346656037ull;
+    for (Color pixel : m_pixels) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            hash = (hash ^ ((pixel >> shift) & 0xFF)) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+bool PixelRenderer::WritePpm(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = std::fprintf(file, "P6\n%d %d\n255\n", m_width, m_height) > 0;
+    std::vector<uint8_t> row((size_t)m_width * 3);
+    for (int y = 0; y < m_height && ok; y++) {
+        for (int x = 0; x < m_width; x++) {
+            Color pixel = Pixel(x, y);
+            row[x * 3] = (uint8_t)ColorRed(pixel);
+            row[x * 3 + 1] = (uint8_t)ColorGreen(pixel);
+            row[x * 3 + 2] = (uint8_t)ColorBlue(pixel);
+        }
+        ok = std::fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+
+    return (std::fclose(file) == 0) && ok;
+}
+
+Rect PixelRenderer::Clip(const Rect& rect) const {
+    return Clip(rect, m_clip);
+}
+
+Rect PixelRenderer::Clip(const Rect& rect, const Rect& clip) const {
+    Rect clipped = {
+        std::max({rect.left, clip.left, m_clip.left, 0}),
+        std::max({rect.top, clip.top, m_clip.top, 0}),
+        std::min({rect.right, clip.right, m_clip.right, m_width}),
+        std::min({rect.bottom, clip.bottom, m_clip.bottom, m_height})
+    };
+    return clipped;
+}
+
+void PixelRenderer::FillRect(const Rect& rect, Color color) {
+    Rect clipped = Clip(rect);
+    if (clipped.IsEmpty()) {
+        return;
+    }
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        Color* row = &m_pixels[(size_t)y * m_width];
+        std::fill(row + clipped.left, row + clipped.right, color);
+    }
+}
+
+void PixelRenderer::FrameRect(const Rect& rect, Color color, int thickness) {
+    // Lines along the outermost pixels of rect, as GDI draws a pen outline
+    Line(rect.left, rect.top, rect.right - 1, rect.top, color, thickness);
+    Line(rect.left, rect.bottom - 1, rect.right - 1, rect.bottom - 1, color, thickness);
+    Line(rect.left, rect.top, rect.left, rect.bottom - 1, color, thickness);
+    Line(rect.right - 1, rect.top, rect.right - 1, rect.bottom - 1, color, thickness);
+}
+
+void PixelRenderer::Line(int x0, int y0, int x1, int y1, Color color, int thickness) {
+    // Thickness spreads across the line, the extra pixel of an even width before it;
+    // the ends are squared off thickness / 2 past the end points
+    int before = thickness / 2;
+    if (x0 == x1) {
+        FillRect({x0 - before, std::min(y0, y1) - before, x0 - before + thickness,
+                  std::max(y0, y1) - before + thickness}, color);
+    } else if (y0 == y1) {
+        FillRect({std::min(x0, x1) - before, y0 - before, std::max(x0, x1) - before + thickness,
+                  y0 - before + thickness}, color);
+    }
+}
+
+void PixelRenderer::Text(const Rect& rect, const wchar_t* text, FontId font, Color color, TextAlign align) {
+    int height = FONT_HEIGHTS[(int)font];
+    int advance = height / 2;
+    int blockWidth = advance - std::max(height / 10, 1);
+    int blockHeight = height * 3 / 5;
+
+    int length = 0;
+    while (text[length] != L'\0') {
+        length++;
+    }
+
+    int x = (align == TextAlign::Center) ? rect.left + (rect.right - rect.left - length * advance) / 2 : rect.left;
+    int y = rect.top + (rect.bottom - rect.top - blockHeight) / 2;
+    for (int i = 0; i < length; i++, x += advance) {
+        if (text[i] != L' ') {
+            Rect block = Clip({x, y, x + blockWidth, y + blockHeight}, rect);
+            if (!block.IsEmpty()) {
+                FillRect(block, color);
+            }
+        }
+    }
+}
+
+const PixelRenderer::Sprite& PixelRenderer::GlyphSprite(Glyph glyph, int width, int height, Color color,
+                                                         Color background) {
+    for (const Sprite& sprite : m_sprites) {
+        if (sprite.glyph == glyph && sprite.width == width && sprite.height == height && sprite.color == color &&
+            sprite.background == background) {
+            return sprite;
+        }
+    }
+
+    // Strokes sized like the game font's letters, centred in the cell
+    Sprite sprite = {glyph, width, height, color, background, std::vector<Color>((size_t)width * height, background)};
+    double size = FONT_HEIGHTS[(int)FontId::Game] * 0.75;
+    double stroke = size / 6.0;
+    double centerX = (width - 1) / 2.0;
+    double centerY = (height - 1) / 2.0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            double dx = x - centerX;
+            double dy = y - centerY;
+            bool inside;
+            if (glyph == Glyph::X) {
+                double reach = size / 2.0;
+                inside = dx >= -reach && dx <= reach && dy >= -reach && dy <= reach &&
+                         (std::abs(dx - dy) <= stroke * 0.7 || std::abs(dx + dy) <= stroke * 0.7);
+            } else {
+                double distance = dx * dx + dy * dy;
+                double outer = size / 2.0;
+                double inner = outer - stroke;
+                inside = distance <= outer * outer && distance >= inner * inner;
+            }
+            if (inside) {
+                sprite.pixels[(size_t)y * width + x] = color;
+            }
+        }
+    }
+
+    m_sprites.push_back(std::move(sprite));
+    return m_sprites.back();
+}
+
+void PixelRenderer::DrawGlyph(const Rect& cell, Glyph glyph, Color color, Color background) {
+    const Sprite& sprite = GlyphSprite(glyph, cell.right - cell.left, cell.bottom - cell.top, color, background);
+    Rect clipped = Clip(cell);
+    if (clipped.IsEmpty()) {
+        return;
+    }
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        const Color* source = &sprite.pixels[(size_t)(y - cell.top) * sprite.width + (clipped.left - cell.left)];
+        std::copy(source, source + (clipped.right - clipped.left), &m_pixels[(size_t)y * m_width + clipped.left]);
+    }
+}
+
+void PixelRenderer::Blend(const Rect& rect, Color color, uint8_t alpha) {
+    Rect clipped = Clip(rect);
+    int inverse = 255 - alpha;
+    int red = ColorRed(color) * alpha;
+    int green = ColorGreen(color) * alpha;
+    int blue = ColorBlue(color) * alpha;
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        Color* row = &m_pixels[(size_t)y * m_width];
+        for (int x = clipped.left; x < clipped.right; x++) {
+            Color pixel = row[x];
+            row[x] = MakeColor((red + ColorRed(pixel) * inverse + 127) / 255,
+                               (green + ColorGreen(pixel) * inverse + 127) / 255,
+                               (blue + ColorBlue(pixel) * inverse + 127) / 255);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "render.h"
+
+// Renderer drawing into a 32-bit pixel buffer in memory, for timing frames and
+// comparing them against golden images on any platform. There is no font engine:
+// text is drawn as one solid block per character, so images still show where every
+// string sits and how long it is.
+class PixelRenderer : public Renderer {
+public:
+    // Sizes the frame and clears the clip; the buffer is only reallocated when the size changes
+    void Resize(int width, int height);
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    const Color* Pixels() const { return m_pixels.data(); }
+    Color Pixel(int x, int y) const { return m_pixels[(size_t)y * m_width + x]; }
+
+    // FNV-1a of the pixels, for comparing frames without storing them
+    uint64_t Checksum() const;
+
+    // Saves the frame as a binary PPM (P6) image
+    bool WritePpm(const std::string& path) const;
+
+    void SetClip(const Rect& clip) override;
+    void FillRect(const Rect& rect, Color color) override;
+    void FrameRect(const Rect& rect, Color color, int thickness) override;
+    void Line(int x0, int y0, int x1, int y1, Color color, int thickness) override;
+    void Text(const Rect& rect, const wchar_t* text, FontId font, Color color, TextAlign align) override;
+    void DrawGlyph(const Rect& cell, Glyph glyph, Color color, Color background) override;
+    void Blend(const Rect& rect, Color color, uint8_t alpha) override;
+
+private:
+    struct Sprite {
+        Glyph glyph;
+        int width;
+        int height;
+        Color color;
+        Color background;
+        std::vector<Color> pixels;
+    };
+
+    // The sprite for these parameters, rendered on first use
+    const Sprite& GlyphSprite(Glyph glyph, int width, int height, Color color, Color background);
+
+    // Rect clipped to the frame and the current clip, and to clip
+    Rect Clip(const Rect& rect) const;
+    Rect Clip(const Rect& rect, const Rect& clip) const;
+
+    std::vector<Color> m_pixels;
+    int m_width = 0;
+    int m_height = 0;
+    Rect m_clip = {0, 0, 0, 0};
+    std::vector<Sprite> m_sprites;
+};
@@ -0,0 +1,427 @@
+#include "ai_player.h"
+#include "game_record.h"
+#include "move_list.h"
+#include "perfect_play.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Regression check for the AI: re-runs every difficulty on a fixed set of 3x3 positions
+// with a fixed seed and compares the moves and scores with a golden file written earlier,
+// reporting any position that changed and how long each move took.
+//
+// Usage: position_replay --record GOLDEN [--seed S] [--playouts P] [--repeat R] [CORPUS...]
+//        position_replay [--repeat R] [--max-slowdown F] [--show N] GOLDEN
+//   --record searches every unfinished position reached in the CORPUS files (game record
+//   files or move-list logs, see game_analyzer) and writes the answers to GOLDEN; with no
+//   corpus it uses every playable position. Without --record the positions in GOLDEN are
+//   replayed with its seed and playouts and compared. Each move is timed R times (default
+//   3) and the fastest kept. --max-slowdown fails the check if a difficulty's total time
+//   exceeds F times the golden total. Exits with 1 on any difference.
+//
+// Golden file, one line per position and mode after the header:
+//
+//   xo-replay 1 seed S playouts P
+//   BOARD MODE CELL SCORE NANOSECONDS
+//
+//   BOARD is the 3x3 board row by row as X, O and '.'; MODE is easy, normal, hard, mcts or
+//   minimax (GetSearchedMove, the live search behind hard); CELL is row * 3 + col or -1;
+//   SCORE is the perfect-play value of the move for the side playing it, or for minimax
+//   Minimax's own score. Easy, normal and mcts depend on the standard library's random
+//   distributions, so golden files only carry over between builds with the same one.
+
+static const char* MODE_NAMES[] = {"easy", "normal", "hard", "mcts", "minimax"};
+static constexpr int MODE_COUNT = 5;
+static constexpr int MINIMAX_MODE = 4;
+
+struct Answer {
+    int cell = -1;
+    int score = 0;
+    uint64_t nanoseconds = 0;
+};
+
+struct GoldenFile {
+    uint32_t seed = 0;
+    uint64_t playouts = 0;
+    std::vector<Bitboard> positions;
+    std::vector<std::array<Answer, MODE_COUNT>> answers;    // By position, then mode
+};
+
+static std::string FormatBoard(const Bitboard& board) {
+    std::string text(BOARD_CELLS, '.');
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        if (board.x & (1u << cell)) {
+            text[cell] = 'X';
+        } else if (board.o & (1u << cell)) {
+            text[cell] = 'O';
+        }
+    }
+    return text;
+}
+
+static bool ParseBoard(const char* text, Bitboard& board) {
+    board = Bitboard();
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        if (text[cell] == 'X') {
+            board.x |= 1u << cell;
+        } else if (text[cell] == 'O') {
+            board.o |= 1u << cell;
+        } else if (text[cell] != '.') {
+            return false;
+        }
+    }
+    return text[BOARD_CELLS] == '\0';
+}
+
+static bool IsOver(const Bitboard& board) {
+    return board.HasWon(Mark::X) || board.HasWon(Mark::O) || board.IsFull();
+}
+
+// Adds the unfinished positions a game passes through, stopping at an illegal move
+static void CollectPositions(const GameRecord& record, std::unordered_set<uint32_t>& seen,
+                             std::vector<Bitboard>& positions) {
+    Bitboard board;
+    for (int i = 0; i <= record.moveCount && !IsOver(board); i++) {
+        if (seen.insert(board.x | ((uint32_t)board.o << BOARD_CELLS)).second) {
+            positions.push_back(board);
+        }
+        if (i == record.moveCount) {
+            break;
+        }
+        int cell = record.moves[i];
+        if (cell >= BOARD_CELLS || !board.IsEmpty(cell)) {
+            break;
+        }
+        board = board.Play(cell, board.ToMove());
+    }
+}
+
+static bool LoadCorpus(const char* path, std::unordered_set<uint32_t>& seen, std::vector<Bitboard>& positions) {
+    GameRecordReader reader;
+    if (reader.Open(path)) {
+        if (reader.BoardSize() != 3) {
+            return false;
+        }
+        while (const GameRecord* record = reader.Next()) {
+            CollectPositions(*record, seen, positions);
+        }
+        return !reader.Failed();
+    }
+
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::string text;
+    char chunk[65536];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, read);
+    }
+    std::fclose(file);
+
+    const char* cursor = text.data();
+    const char* end = text.data() + text.size();
+    GameRecord record;
+    MoveListLine kind;
+    while (cursor < end) {
+        cursor = ParseMoveListLine(cursor, end, record, kind);
+        if (kind == MoveListLine::Game) {
+            CollectPositions(record, seen, positions);
+        }
+    }
+    return true;
+}
+
+// Every position reachable in a game that is not yet over, in order of move count
+static std::vector<Bitboard> PlayablePositions() {
+    std::vector<Bitboard> positions;
+    std::unordered_set<uint32_t> seen;
+    std::vector<Bitboard> frontier = {Bitboard()};
+    while (!frontier.empty()) {
+        std::vector<Bitboard> next;
+        for (const Bitboard& board : frontier) {
+            positions.push_back(board);
+            for (uint16_t empty = board.EmptyCells(); empty; empty &= empty - 1) {
+                Bitboard child = board.Play(LowestCell(empty), board.ToMove());
+                if (!IsOver(child) && seen.insert(child.x | ((uint32_t)child.o << BOARD_CELLS)).second) {
+                    next.push_back(child);
+                }
+            }
+        }
+        frontier = std::move(next);
+    }
+    return positions;
+}
+
+// One move of one mode from a fresh start: the seed is reset and the MonteCarlo tree
+// dropped, and minimax also starts from an empty transposition table, so the answer
+// does not depend on the positions searched before
+static Answer Run(AIPlayer& ai, const Bitboard& board, int mode, uint32_t seed, int repeat) {
+    Answer answer;
+    for (int r = 0; r < repeat; r++) {
+        ai.SetSeed(seed);
+        if (mode == MINIMAX_MODE) {
+            ai.ClearSearchCache();
+        } else {
+            ai.NewGame();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::pair<int, int> move;
+        int score = 0;
+        if (mode == MINIMAX_MODE) {
+            move = ai.GetSearchedMove(board, board.ToMove(), &score);
+        } else {
+            move = ai.GetBestMove(board, board.ToMove(), (AIPlayer::Difficulty)mode);
+        }
+        uint64_t nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        int cell = (move.first < 0) ? -1 : move.first * 3 + move.second;
+        if (mode != MINIMAX_MODE && cell >= 0 && board.IsEmpty(cell)) {
+            // The position after the move is valued for the opponent
+            score = -LookupPerfectPlay(board.Play(cell, board.ToMove())).value;
+        }
+
+        answer.cell = cell;
+        answer.score = score;
+        answer.nanoseconds = (r == 0) ? nanoseconds : std::min(answer.nanoseconds, nanoseconds);
+    }
+    return answer;
+}
+
+static bool ReadGolden(const char* path, GoldenFile& golden) {
+    std::FILE* file = std::fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    int version = 0;
+    unsigned long long playouts = 0;
+    bool ok = std::fscanf(file, " xo-replay %d seed %u playouts %llu", &version, &golden.seed, &playouts) == 3 &&
+              version == 1;
+    golden.playouts = playouts;
+
+    char boardText[16];
+    char modeText[16];
+    int cell;
+    int score;
+    unsigned long long nanoseconds;
+    while (ok && std::fscanf(file, " %15s %15s %d %d %llu", boardText, modeText, &cell, &score, &nanoseconds) == 5) {
+        Bitboard board;
+        int mode = 0;
+        while (mode < MODE_COUNT && std::strcmp(modeText, MODE_NAMES[mode]) != 0) {
+            mode++;
+        }
+        if (!ParseBoard(boardText, board) || mode == MODE_COUNT) {
+            ok = false;
+            break;
+        }
+
+        // Lines of one position are consecutive
+        if (golden.positions.empty() || !(golden.positions.back() == board)) {
+            golden.positions.push_back(board);
+            golden.answers.emplace_back();
+        }
+        golden.answers.back()[mode] = {cell, score, nanoseconds};
+    }
+
+    ok = ok && std::feof(file);
+    std::fclose(file);
+    return ok;
+}
+
+static bool WriteGolden(const char* path, const GoldenFile& golden) {
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = std::fprintf(file, "xo-replay 1 seed %u playouts %llu\n", golden.seed,
+                           (unsigned long long)golden.playouts) > 0;
+    for (size_t i = 0; i < golden.positions.size() && ok; i++) {
+        std::string board = FormatBoard(golden.positions[i]);
+        for (int mode = 0; mode < MODE_COUNT; mode++) {
+            const Answer& answer = golden.answers[i][mode];
+            ok = ok && std::fprintf(file, "%s %s %d %d %llu\n", board.c_str(), MODE_NAMES[mode], answer.cell,
+                                    answer.score, (unsigned long long)answer.nanoseconds) > 0;
+        }
+    }
+
+    return (std::fclose(file) == 0) && ok;
+}
+
+static double Percentile(std::vector<uint64_t> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return (double)values[index];
+}
+
+// Per-mode timing table; golden, if given, adds each mode's total against the golden one.
+// Returns the largest of those ratios.
+static double PrintTimings(const GoldenFile& current, const GoldenFile* golden) {
+    std::printf("\n%-10s %12s %10s %10s %10s %10s", "Mode", "total ms", "mean us", "p50 us", "p99 us", "max us");
+    std::printf(golden ? " %10s %8s\n" : "\n", "golden ms", "ratio");
+
+    double worst = 0.0;
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        std::vector<uint64_t> times;
+        uint64_t total = 0;
+        uint64_t goldenTotal = 0;
+        for (size_t i = 0; i < current.positions.size(); i++) {
+            times.push_back(current.answers[i][mode].nanoseconds);
+            total += current.answers[i][mode].nanoseconds;
+            if (golden) {
+                goldenTotal += golden->answers[i][mode].nanoseconds;
+            }
+        }
+
+        uint64_t slowest = times.empty() ? 0 : *std::max_element(times.begin(), times.end());
+        std::printf("%-10s %12.3f %10.3f %10.3f %10.3f %10.3f", MODE_NAMES[mode], total / 1e6,
+                    times.empty() ? 0.0 : total / 1e3 / times.size(), Percentile(times, 0.5) / 1e3,
+                    Percentile(times, 0.99) / 1e3, slowest / 1e3);
+        if (golden) {
+            double ratio = goldenTotal ? (double)total / goldenTotal : 0.0;
+            worst = std::max(worst, ratio);
+            std::printf(" %10.3f %7.2fx", goldenTotal / 1e6, ratio);
+        }
+        std::printf("\n");
+    }
+    return worst;
+}
+
+static void PrintUsage(const char* program) {
+    std::fprintf(stderr,
+                 "Usage: %s --record GOLDEN [--seed S] [--playouts P] [--repeat R] [CORPUS...]\n"
+                 "       %s [--repeat R] [--max-slowdown F] [--show N] GOLDEN\n", program, program);
+}
+
+int main(int argc, char* argv[]) {
+    const char* recordPath = nullptr;
+    uint32_t seed = 20240601;
+    uint64_t playouts = 1000;
+    int repeat = 3;
+    double maxSlowdown = 0.0;
+    int show = 20;
+    std::vector<const char*> paths;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--playouts") == 0 && i + 1 < argc) {
+            playouts = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(std::atoi(argv[++i]), 1);
+        } else if (std::strcmp(argv[i], "--max-slowdown") == 0 && i + 1 < argc) {
+            maxSlowdown = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--show") == 0 && i + 1 < argc) {
+            show = std::atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    GoldenFile golden;
+    if (recordPath) {
+        golden.seed = seed;
+        golden.playouts = playouts;
+        std::unordered_set<uint32_t> seen;
+        for (const char* path : paths) {
+            if (!LoadCorpus(path, seen, golden.positions)) {
+                std::fprintf(stderr, "Cannot read %s as a 3x3 game file\n", path);
+                return 1;
+            }
+        }
+        if (paths.empty()) {
+            golden.positions = PlayablePositions();
+        }
+    } else if (paths.size() != 1) {
+        PrintUsage(argv[0]);
+        return 1;
+    } else if (!ReadGolden(paths[0], golden)) {
+        std::fprintf(stderr, "Cannot read golden file %s\n", paths[0]);
+        return 1;
+    }
+
+    // Replay with the golden file's settings so only code changes can move the answers
+    GoldenFile current;
+    current.seed = golden.seed;
+    current.playouts = golden.playouts;
+    current.positions = golden.positions;
+    current.answers.resize(current.positions.size());
+
+    AIPlayer ai;
+    ai.SetPlayoutBudget(golden.playouts);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < current.positions.size(); i++) {
+        for (int mode = 0; mode < MODE_COUNT; mode++) {
+            current.answers[i][mode] = Run(ai, current.positions[i], mode, golden.seed, repeat);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%zu positions x %d modes, seed %u, %llu playouts, best of %d, %.3f s\n",
+                current.positions.size(), MODE_COUNT, golden.seed, (unsigned long long)golden.playouts, repeat,
+                seconds);
+
+    if (recordPath) {
+        PrintTimings(current, nullptr);
+        if (!WriteGolden(recordPath, current)) {
+            std::fprintf(stderr, "Cannot write %s\n", recordPath);
+            return 1;
+        }
+        std::printf("\nWrote %s\n", recordPath);
+        return 0;
+    }
+
+    // Moves and scores must match exactly; timings only against --max-slowdown
+    std::array<int, MODE_COUNT> divergences = {};
+    int shown = 0;
+    for (size_t i = 0; i < current.positions.size(); i++) {
+        for (int mode = 0; mode < MODE_COUNT; mode++) {
+            const Answer& expected = golden.answers[i][mode];
+            const Answer& actual = current.answers[i][mode];
+            if (expected.cell == actual.cell && expected.score == actual.score) {
+                continue;
+            }
+            divergences[mode]++;
+            if (shown++ < show) {
+                std::printf("DIVERGED %s %-8s golden cell %2d score %3d, now cell %2d score %3d\n",
+                            FormatBoard(current.positions[i]).c_str(), MODE_NAMES[mode], expected.cell,
+                            expected.score, actual.cell, actual.score);
+            }
+        }
+    }
+
+    double worst = PrintTimings(current, &golden);
+
+    bool ok = true;
+    std::printf("\n");
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        std::printf("%-10s %d divergences\n", MODE_NAMES[mode], divergences[mode]);
+        ok = ok && divergences[mode] == 0;
+    }
+    if (maxSlowdown > 0.0 && worst > maxSlowdown) {
+        std::printf("Slowest mode took %.2fx its golden time, over the %.2fx limit\n", worst, maxSlowdown);
+        ok = false;
+    }
+
+    std::printf("%s\n", ok ? "Replay matches the golden file" : "Replay FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+// Drawing primitives shared by the screen painter and its backends: GdiRenderer draws
+// to the window, PixelRenderer into memory so frames can be timed and compared
+// without Windows.
+
+// 0x00RRGGBB
+using Color = uint32_t;
+
+constexpr Color MakeColor(int r, int g, int b) {
+    return ((Color)r << 16) | ((Color)g << 8) | (Color)b;
+}
+
+constexpr int ColorRed(Color color) { return (color >> 16) & 0xFF; }
+constexpr int ColorGreen(Color color) { return (color >> 8) & 0xFF; }
+constexpr int ColorBlue(Color color) { return color & 0xFF; }
+
+// Right and bottom are exclusive, as in a Win32 RECT
+struct Rect {
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    bool IsEmpty() const { return right <= left || bottom <= top; }
+
+    // Edges included, matching how the window has always hit-tested its buttons
+    bool Contains(int x, int y) const { return x >= left && x <= right && y >= top && y <= bottom; }
+
+    bool Contains(const Rect& other) const {
+        return other.left >= left && other.top >= top && other.right <= right && other.bottom <= bottom;
+    }
+
+    bool Intersects(const Rect& other) const {
+        return left < other.right && other.left < right && top < other.bottom && other.top < bottom;
+    }
+
+    bool operator==(const Rect& other) const {
+        return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+    }
+    bool operator!=(const Rect& other) const { return !(*this == other); }
+};
+
+// Smallest rectangle covering both
+inline Rect Union(const Rect& a, const Rect& b) {
+    return {a.left < b.left ? a.left : b.left, a.top < b.top ? a.top : b.top,
+            a.right > b.right ? a.right : b.right, a.bottom > b.bottom ? a.bottom : b.bottom};
+}
+
+enum class FontId { Title, Button, Game, Status };
+
+// Pixel heights of the fonts, in FontId order
+constexpr int FONT_HEIGHTS[] = {48, 20, 60, 24};
+
+enum class TextAlign { Left, Center };
+
+enum class Glyph { X, O };
+
+class Renderer {
+public:
+    virtual ~Renderer() = default;
+
+    // Limits every following call to clip, so a frame can redraw just the areas that changed
+    virtual void SetClip(const Rect& clip) = 0;
+
+    virtual void FillRect(const Rect& rect, Color color) = 0;
+
+    // Outline of the given thickness centred on the rectangle's edge
+    virtual void FrameRect(const Rect& rect, Color color, int thickness) = 0;
+
+    // Horizontal or vertical line of the given thickness centred on it
+    virtual void Line(int x0, int y0, int x1, int y1, Color color, int thickness) = 0;
+
+    // Single line of text centred vertically in rect and clipped to it
+    virtual void Text(const Rect& rect, const wchar_t* text, FontId font, Color color, TextAlign align) = 0;
+
+    // X or O filling a board cell, from a sprite rendered once per cell size and colours
+    virtual void DrawGlyph(const Rect& cell, Glyph glyph, Color color, Color background) = 0;
+
+    // Mixes color over rect at alpha / 255 opacity
+    virtual void Blend(const Rect& rect, Color color, uint8_t alpha) = 0;
+};
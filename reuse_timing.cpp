@@ -0,0 +1,111 @@
+#include "ai_player.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// Times MonteCarlo vs MonteCarlo moves on 7x7 four in a row with the tree kept
+// between moves (as in a real game) and with it dropped before every move, to show
+// what reusing the subtree below our move and the reply saves. The default budget
+// is about what the game's 500 ms per move buys on one core.
+//
+// Hard is not timed: its transposition table is kept too, but entries from two plies
+// back are two plies too shallow to cut a fixed-depth search, so it gains nothing.
+//
+// Usage: reuse_timing [--games N] [--playouts P] [--seed S]
+
+struct MoveTiming {
+    int moves = 0;
+    double seconds = 0.0;
+    uint64_t playouts = 0;
+    uint64_t reusedVisits = 0;
+};
+
+using Board = GridBoard<7, 4>;
+
+static std::pair<int, int> TimeMove(AIPlayer& player, const Board& board, Mark toMove, MoveTiming& timing) {
+    auto start = std::chrono::steady_clock::now();
+    std::pair<int, int> move = player.GetBestMove(board, toMove, AIPlayer::Difficulty::MonteCarlo);
+    timing.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    timing.moves++;
+    timing.playouts += player.LastMctsResult().playouts;
+    timing.reusedVisits += player.LastMctsResult().reusedVisits;
+    return move;
+}
+
+// Plays games between two players that keep their trees between moves, each game
+// opening with two random moves. Before every move a third player with its tree
+// dropped searches the same position, so both runs are timed on identical positions.
+static void PlayGames(int games, uint64_t playouts, uint32_t seed, MoveTiming& reuse, MoveTiming& fresh) {
+    AIPlayer players[3];
+    std::mt19937 openings(seed);
+    
+    for (int i = 0; i < 3; i++) {
+        players[i].SetSeed(seed + i);
+        players[i].SetPlayoutBudget(playouts);
+    }
+    AIPlayer& freshPlayer = players[2];
+    
+    for (int game = 0; game < games; game++) {
+        Board board;
+        players[0].NewGame();
+        players[1].NewGame();
+        
+        for (int i = 0; i < 2; i++) {
+            int cell;
+            do {
+                cell = std::uniform_int_distribution<int>(0, Board::CELLS - 1)(openings);
+            } while (!board.IsEmpty(cell));
+            board.Place(cell, board.ToMove());
+        }
+        
+        while (!board.HasWon(Mark::X) && !board.HasWon(Mark::O) && !board.IsFull()) {
+            Mark toMove = board.ToMove();
+            freshPlayer.ClearSearchCache();
+            TimeMove(freshPlayer, board, toMove, fresh);
+            
+            std::pair<int, int> move = TimeMove(players[(int)toMove], board, toMove, reuse);
+            board.Place(move.first * Board::SIZE + move.second, toMove);
+        }
+    }
+}
+
+static void Report(const char* name, const MoveTiming& reuse, const MoveTiming& fresh) {
+    double reuseMs = reuse.seconds * 1000.0 / reuse.moves;
+    double freshMs = fresh.seconds * 1000.0 / fresh.moves;
+    std::printf("%-22s %10.2f %10.2f %8.2fx   %llu playouts/move fresh, %llu with reuse (%llu visits kept)\n", 
+                name, freshMs, reuseMs, freshMs / reuseMs, 
+                (unsigned long long)(fresh.playouts / fresh.moves), (unsigned long long)(reuse.playouts / reuse.moves),
+                (unsigned long long)(reuse.reusedVisits / reuse.moves));
+}
+
+int main(int argc, char* argv[]) {
+    int games = 4;
+    uint64_t playouts = 250000;
+    uint32_t seed = 1;
+    
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--playouts") == 0 && i + 1 < argc) {
+            playouts = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--games N] [--playouts P] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    std::printf("7x7, 4 in a row, %d games per run, seed %u\n", games, seed);
+    std::printf("%-22s %10s %10s %9s\n", "player", "fresh ms", "reuse ms", "speedup");
+    
+    char name[64];
+    std::snprintf(name, sizeof(name), "MonteCarlo %llu", (unsigned long long)playouts);
+    MoveTiming reuse, fresh;
+    PlayGames(games, playouts, seed, reuse, fresh);
+    Report(name, reuse, fresh);
+    
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "scene_model.h"
+
+void DirtyRegion::Add(const Rect& rect) {
+    if (rect.IsEmpty()) {
+        return;
+    }
+
+    // Merge with every rectangle it touches; a merge can reach others, so start over
+    Rect merged = rect;
+    for (int i = 0; i < m_count; i++) {
+        if (m_rects[i].Contains(merged)) {
+            return;
+        }
+        if (m_rects[i].Intersects(merged)) {
+            merged = Union(m_rects[i], merged);
+            m_rects[i] = m_rects[--m_count];
+            i = -1;
+        }
+    }
+
+    if (m_count < MAX_RECTS) {
+        m_rects[m_count++] = merged;
+        return;
+    }
+
+    // Full: grow the rectangle that gains the least area, then fold in anything it now overlaps
+    int best = 0;
+    int64_t bestGrowth = INT64_MAX;
+    for (int i = 0; i < m_count; i++) {
+        Rect grown = Union(m_rects[i], merged);
+        int64_t growth = (int64_t)(grown.right - grown.left) * (grown.bottom - grown.top) -
+                         (int64_t)(m_rects[i].right - m_rects[i].left) * (m_rects[i].bottom - m_rects[i].top);
+        if (growth < bestGrowth) {
+            best = i;
+            bestGrowth = growth;
+        }
+    }
+    merged = Union(m_rects[best], merged);
+    m_rects[best] = m_rects[--m_count];
+    Add(merged);
+}
+
+int64_t DirtyRegion::Area() const {
+    int64_t area = 0;
+    for (const Rect& rect : *this) {
+        area += (int64_t)(rect.right - rect.left) * (rect.bottom - rect.top);
+    }
+    return area;
+}
+
+int SceneModel::CellValue(const SceneState& scene, int row, int col) {
+    if (!scene.game || scene.game->IsEmpty(row, col)) {
+        return 0;
+    }
+    return scene.game->Has(row, col, Mark::X) ? 1 : 2;
+}
+
+void SceneModel::Update(const SceneState& scene, const UiLayout& layout, DirtyRegion& region) {
+    const wchar_t* status = scene.statusText ? scene.statusText : L"";
+
+    // A new screen, a welcome screen gaining or losing its difficulty row, or a new
+    // game-over title moves or covers everything
+    if (!m_valid || layout.Generation() != m_layout) {
+        region.Add(UiLayout::WindowRect());
+    } else {
+        // Widgets keep their places within a layout, so only their look can change
+        for (const Widget& widget : layout) {
+            bool changed = false;
+            if (widget.kind == WidgetKind::Button) {
+                changed = (scene.hoveredButton == widget.button) != (m_shown.hoveredButton == widget.button) ||
+                          UiLayout::IsActive(scene, widget.action) != UiLayout::IsActive(m_shown, widget.action);
+            } else if (widget.kind == WidgetKind::Cell) {
+                bool hovered = (widget.row == scene.hoverRow && widget.col == scene.hoverCol);
+                bool wasHovered = (widget.row == m_shown.hoverRow && widget.col == m_shown.hoverCol);
+                int shown = m_cells[widget.row * UiLayout::GRID_SIZE + widget.col];
+                changed = hovered != wasHovered || CellValue(scene, widget.row, widget.col) != shown;
+            } else if (widget.kind == WidgetKind::Status) {
+                for (int i = 0; i < STATUS_CAPACITY - 1 && !changed; i++) {
+                    changed = status[i] != m_status[i];
+                    if (status[i] == L'\0') {
+                        break;
+                    }
+                }
+            }
+            if (changed) {
+                region.Add(widget.rect);
+            }
+        }
+    }
+
+    m_valid = true;
+    m_layout = layout.Generation();
+    m_shown = scene;
+    m_shown.game = nullptr;
+    m_shown.statusText = L"";
+    for (int row = 0; row < UiLayout::GRID_SIZE; row++) {
+        for (int col = 0; col < UiLayout::GRID_SIZE; col++) {
+            m_cells[row * UiLayout::GRID_SIZE + col] = (uint8_t)CellValue(scene, row, col);
+        }
+    }
+    int length = 0;
+    for (; length < STATUS_CAPACITY - 1 && status[length] != L'\0'; length++) {
+        m_status[length] = status[length];
+    }
+    m_status[length] = L'\0';
+}
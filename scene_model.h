@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "ui_layout.h"
+
+// A few rectangles that need repainting. Overlapping rectangles are merged, and once
+// the list is full a new rectangle is merged into the one it enlarges least, so the
+// region stays small enough to paint one rectangle at a time.
+class DirtyRegion {
+public:
+    static constexpr int MAX_RECTS = 8;
+
+    void Add(const Rect& rect);
+    void Clear() { m_count = 0; }
+
+    bool IsEmpty() const { return m_count == 0; }
+    int Count() const { return m_count; }
+    const Rect& operator[](int index) const { return m_rects[index]; }
+    const Rect* begin() const { return m_rects.data(); }
+    const Rect* end() const { return m_rects.data() + m_count; }
+
+    // Pixels covered, counting overlaps once per rectangle
+    int64_t Area() const;
+
+private:
+    std::array<Rect, MAX_RECTS> m_rects;
+    int m_count = 0;
+};
+
+// What the window showed after the last update, kept so the next one can work out the
+// smallest areas that changed: single cells for hover and moves, single buttons for
+// hover and selection, the status line, or the whole window when the layout changes.
+class SceneModel {
+public:
+    // Adds to region everything that looks different in scene, laid out by layout, and
+    // remembers scene as shown. The first update and any new layout cover the whole window.
+    void Update(const SceneState& scene, const UiLayout& layout, DirtyRegion& region);
+
+    // Forgets what is shown, so the next update repaints everything
+    void Reset() { m_valid = false; }
+
+private:
+    static constexpr int STATUS_CAPACITY = 64;
+
+    // Cell contents as 0 for empty, 1 for X and 2 for O
+    static int CellValue(const SceneState& scene, int row, int col);
+
+    bool m_valid = false;
+    uint32_t m_layout = 0;      // UiLayout::Generation of the layout shown
+    SceneState m_shown;
+    std::array<uint8_t, UiLayout::GRID_SIZE * UiLayout::GRID_SIZE> m_cells = {};
+    std::array<wchar_t, STATUS_CAPACITY> m_status = {};   // Copy of the status text, cut to fit
+};
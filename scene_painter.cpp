@@ -0,0 +1,148 @@
+#include "scene_painter.h"
+#include <cwchar>
+
+// Color definitions for modern UI
+static constexpr Color UI_BACKGROUND = MakeColor(245, 245, 245);       // Lighter background
+static constexpr Color COLOR_CELL = MakeColor(255, 255, 255);          // White cells
+static constexpr Color COLOR_HOVER = MakeColor(235, 245, 255);         // Light blue hover
+static constexpr Color COLOR_GRID = MakeColor(60, 60, 60);             // Darker gray grid
+static constexpr Color COLOR_BOARD_FRAME = MakeColor(50, 50, 50);
+static constexpr Color COLOR_X = MakeColor(41, 128, 185);              // Bright blue for X
+static constexpr Color COLOR_O = MakeColor(231, 76, 60);               // Bright red for O
+static constexpr Color COLOR_BUTTON = MakeColor(52, 152, 219);         // Bright blue
+static constexpr Color COLOR_BUTTON_HOVER = MakeColor(41, 128, 185);   // Darker blue for hover
+static constexpr Color COLOR_BUTTON_ACTIVE = MakeColor(25, 99, 145);   // Even darker blue for active/pressed
+static constexpr Color COLOR_BUTTON_FRAME = MakeColor(20, 20, 20);     // Dark frame for buttons
+static constexpr Color COLOR_BUTTON_TEXT = MakeColor(255, 255, 255);
+static constexpr Color COLOR_TEXT = MakeColor(0, 0, 0);
+static constexpr Color COLOR_TITLE_SHADOW = MakeColor(100, 100, 100);
+static constexpr Color COLOR_OVERLAY = MakeColor(240, 240, 240);       // Light gray
+static constexpr uint8_t OVERLAY_ALPHA = 180;                          // 70% opacity
+static constexpr Color COLOR_STATS = MakeColor(20, 20, 20);
+static constexpr uint8_t STATS_ALPHA = 200;
+static constexpr Color COLOR_STATS_TEXT = MakeColor(120, 255, 120);
+
+// Frame-time overlay: one line of Status-font text per phase
+static constexpr int STATS_LEFT = 8;
+static constexpr int STATS_TOP = 8;
+static constexpr int STATS_WIDTH = 300;
+static constexpr int STATS_PADDING = 4;
+static constexpr int STATS_LINE_HEIGHT = 26;
+
+void ScenePainter::Paint(Renderer& renderer, const SceneState& scene, const UiLayout& layout) {
+    Paint(renderer, scene, layout, UiLayout::WindowRect());
+}
+
+void ScenePainter::Paint(Renderer& renderer, const SceneState& scene, const UiLayout& layout, const Rect& clip) {
+    renderer.SetClip(clip);
+
+    // Fill background
+    renderer.FillRect(clip, UI_BACKGROUND);
+
+    // Draw the widgets in order, skipping any entirely outside clip; the renderer clips the rest
+    for (const Widget& widget : layout) {
+        if (!widget.rect.Intersects(clip)) {
+            continue;
+        }
+        switch (widget.kind) {
+            case WidgetKind::Label:
+                renderer.Text(widget.rect, widget.text, widget.font, widget.shadow ? COLOR_TITLE_SHADOW : COLOR_TEXT,
+                              widget.align);
+                break;
+            case WidgetKind::Button:
+                DrawButton(renderer, scene, widget);
+                break;
+            case WidgetKind::Board:
+                DrawBoard(renderer);
+                break;
+            case WidgetKind::Cell:
+                DrawCell(renderer, scene, widget.row, widget.col);
+                break;
+            case WidgetKind::Status:
+                renderer.Text(widget.rect, scene.statusText, FontId::Status, COLOR_TEXT, TextAlign::Center);
+                break;
+            case WidgetKind::Overlay:
+                renderer.Blend(clip, COLOR_OVERLAY, OVERLAY_ALPHA);
+                break;
+        }
+    }
+}
+
+void ScenePainter::DrawButton(Renderer& renderer, const SceneState& scene, const Widget& button) {
+    // Select the appropriate color based on state
+    bool isActive = UiLayout::IsActive(scene, button.action);
+    bool isHovered = scene.hoveredButton == button.button;
+    Color color = isActive ? COLOR_BUTTON_ACTIVE : isHovered ? COLOR_BUTTON_HOVER : COLOR_BUTTON;
+
+    // Draw button background and frame
+    renderer.FillRect(button.rect, color);
+    renderer.FrameRect(button.rect, COLOR_BUTTON_FRAME, 1);
+
+    // Draw button text - always white for good contrast
+    renderer.Text(button.rect, button.text, FontId::Button, COLOR_BUTTON_TEXT, TextAlign::Center);
+}
+
+void ScenePainter::DrawBoard(Renderer& renderer) {
+    constexpr int BOARD_LEFT = UiLayout::BOARD_LEFT;
+    constexpr int BOARD_TOP = UiLayout::BOARD_TOP;
+    constexpr int GRID_SIZE = UiLayout::GRID_SIZE;
+    constexpr int CELL_SIZE = UiLayout::CELL_SIZE;
+
+    // Draw a white background for the board with a frame around it
+    Rect boardRect = {
+        BOARD_LEFT - 5,
+        BOARD_TOP - 5,
+        BOARD_LEFT + GRID_SIZE * CELL_SIZE + 5,
+        BOARD_TOP + GRID_SIZE * CELL_SIZE + 5
+    };
+    renderer.FillRect(boardRect, COLOR_CELL);
+    renderer.FrameRect(boardRect, COLOR_BOARD_FRAME, 3);
+
+    // Draw vertical and horizontal lines; the cells are widgets of their own
+    for (int i = 1; i < GRID_SIZE; i++) {
+        renderer.Line(BOARD_LEFT + i * CELL_SIZE, BOARD_TOP, BOARD_LEFT + i * CELL_SIZE,
+                      BOARD_TOP + GRID_SIZE * CELL_SIZE, COLOR_GRID, 2);
+        renderer.Line(BOARD_LEFT, BOARD_TOP + i * CELL_SIZE, BOARD_LEFT + GRID_SIZE * CELL_SIZE,
+                      BOARD_TOP + i * CELL_SIZE, COLOR_GRID, 2);
+    }
+}
+
+void ScenePainter::DrawCell(Renderer& renderer, const SceneState& scene, int row, int col) {
+    Rect cellRect = UiLayout::CellRect(row, col);
+
+    // Draw hover effect
+    bool isHovered = (row == scene.hoverRow && col == scene.hoverCol);
+    Color background = isHovered ? COLOR_HOVER : COLOR_CELL;
+    renderer.FillRect(cellRect, background);
+
+    // Draw X or O
+    if (!scene.game->IsEmpty(row, col)) {
+        bool isX = scene.game->Has(row, col, Mark::X);
+        renderer.DrawGlyph(cellRect, isX ? Glyph::X : Glyph::O, isX ? COLOR_X : COLOR_O, background);
+    }
+}
+
+Rect ScenePainter::StatsOverlayRect() {
+    return {STATS_LEFT, STATS_TOP, STATS_LEFT + STATS_WIDTH,
+            STATS_TOP + 2 * STATS_PADDING + FRAME_PHASE_COUNT * STATS_LINE_HEIGHT};
+}
+
+void ScenePainter::PaintStats(Renderer& renderer, const FrameStats& stats) {
+    static const wchar_t* labels[FRAME_PHASE_COUNT] = {L"input", L"ai", L"draw", L"blit", L"latency"};
+
+    Rect overlay = StatsOverlayRect();
+    renderer.SetClip(overlay);
+    renderer.Blend(overlay, COLOR_STATS, STATS_ALPHA);
+
+    // Formatted into a fixed buffer so the overlay costs no allocations per frame
+    wchar_t line[64];
+    for (int phase = 0; phase < FRAME_PHASE_COUNT; phase++) {
+        const RollingHistogram& histogram = stats.Histogram((FramePhase)phase);
+        std::swprintf(line, sizeof(line) / sizeof(line[0]), L"%ls %u / %u / %u us", labels[phase],
+                      (unsigned)histogram.Percentile(0.5), (unsigned)histogram.Percentile(0.99),
+                      (unsigned)histogram.Max());
+        int top = overlay.top + STATS_PADDING + phase * STATS_LINE_HEIGHT;
+        Rect lineRect = {overlay.left + STATS_PADDING, top, overlay.right - STATS_PADDING, top + STATS_LINE_HEIGHT};
+        renderer.Text(lineRect, line, FontId::Status, COLOR_STATS_TEXT, TextAlign::Left);
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "frame_stats.h"
+#include "render.h"
+#include "ui_layout.h"
+
+// Draws the widgets of a UiLayout through any Renderer, free of Windows code. The
+// layout says where everything goes; the scene says how it looks right now.
+class ScenePainter {
+public:
+    // Draws the whole window for scene; layout must be up to date for it
+    static void Paint(Renderer& renderer, const SceneState& scene, const UiLayout& layout);
+
+    // Draws only the part of the window inside clip
+    static void Paint(Renderer& renderer, const SceneState& scene, const UiLayout& layout, const Rect& clip);
+
+    // Frame-time overlay in the top-left corner: p50, p99 and max of each phase in
+    // microseconds. Drawn over the scene, so repaint the scene under it first.
+    static Rect StatsOverlayRect();
+    static void PaintStats(Renderer& renderer, const FrameStats& stats);
+
+private:
+    static void DrawButton(Renderer& renderer, const SceneState& scene, const Widget& button);
+    static void DrawBoard(Renderer& renderer);
+    static void DrawCell(Renderer& renderer, const SceneState& scene, int row, int col);
+};
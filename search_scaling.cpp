@@ -0,0 +1,88 @@
+#include "game_search.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// Reports nodes/second and time-to-depth for 1..N search threads, to size hosts
+// for the larger board variants.
+//
+// Usage: search_scaling [--threads N] [--depth D]
+
+struct ScalingRun {
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+};
+
+// Fixed-depth search of a few opening moves into a fresh table
+template <int N, int K>
+static ScalingRun RunPositions(int threads, int depth) {
+    TranspositionTable table(22);
+    GameSearch<GridBoard<N, K>> search(table);
+    ScalingRun run;
+    
+    // Empty board, a centre opening and an off-centre reply
+    int centre = (N / 2) * N + N / 2;
+    GridBoard<N, K> positions[3];
+    positions[1].Place(centre, Mark::X);
+    positions[2].Place(centre, Mark::X);
+    positions[2].Place(centre - N - 1, Mark::O);
+    
+    SearchLimits limits;
+    limits.maxDepth = depth;
+    limits.threads = threads;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (const GridBoard<N, K>& board : positions) {
+        run.nodes += search.Search(board, limits).nodes;
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return run;
+}
+
+template <int N, int K>
+static void ReportScaling(int maxThreads, int depth) {
+    std::printf("\n%dx%d, %d in a row, depth %d\n", N, N, K, depth);
+    std::printf("%8s %14s %10s %12s %10s %10s\n", "threads", "nodes", "seconds", "Mnodes/s", "nps x", "time x");
+    
+    ScalingRun baseline;
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        ScalingRun run = RunPositions<N, K>(threads, depth);
+        if (threads == 1) {
+            baseline = run;
+        }
+        
+        double nps = run.nodes / run.seconds;
+        double baseNps = baseline.nodes / baseline.seconds;
+        std::printf("%8d %14llu %10.3f %12.2f %10.2f %10.2f\n", threads, (unsigned long long)run.nodes, 
+                    run.seconds, nps / 1e6, nps / baseNps, baseline.seconds / run.seconds);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = (int)std::thread::hardware_concurrency();
+    int depth = 4;
+    
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            maxThreads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            depth = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--threads N] [--depth D]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    if (maxThreads < 1) {
+        maxThreads = 1;
+    }
+    
+    // Depth 0 would mean no limit, and nothing else stops these searches
+    ReportScaling<7, 4>(maxThreads, std::max(depth, 1));
+    ReportScaling<9, 5>(maxThreads, std::max(depth - 1, 1));
+    ReportScaling<15, 5>(maxThreads, std::max(depth - 2, 1));
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// Work done by one search, summed over its threads
+struct SearchCounters {
+    uint64_t nodes = 0;             // Positions visited
+    uint64_t cutoffs = 0;           // Positions where a move reached beta, ending the search of the rest
+    uint64_t leafEvaluations = 0;   // Positions scored without expanding them: won, full or at the depth limit
+    uint64_t tableProbes = 0;       // Transposition table lookups
+    uint64_t tableHits = 0;         // Lookups that found the position
+    int maxDepth = 0;               // Deepest ply reached below the root
+
+    void Add(const SearchCounters& other) {
+        nodes += other.nodes;
+        cutoffs += other.cutoffs;
+        leafEvaluations += other.leafEvaluations;
+        tableProbes += other.tableProbes;
+        tableHits += other.tableHits;
+        maxDepth = std::max(maxDepth, other.maxDepth);
+    }
+};
+
+// What one root move of the last search came to
+struct RootMoveStats {
+    int cell = -1;
+    int score = 0;          // From the searching side; exact for the best move, an upper bound
+                            // for others searched with a window (the larger-board search)
+    uint64_t nodes = 0;     // Positions below this move, over every iteration that searched it
+    double seconds = 0.0;   // Time in those positions; 0 unless timing was asked for
+};
+
+// How AIPlayer chose its last move, with the counters and root moves of any search behind it
+struct SearchStats : SearchCounters {
+    // Moves beyond this many are counted but not listed
+    static constexpr int MAX_ROOT_MOVES = 64;
+
+    enum class Source { None, Random, PerfectPlay, Book, Search, MonteCarlo };
+
+    Source source = Source::None;
+    double seconds = 0.0;           // Searching time; 0 unless timing was asked for
+    int rootMoveCount = 0;
+    std::array<RootMoveStats, MAX_ROOT_MOVES> rootMoves;
+
+    void Clear() {
+        static_cast<SearchCounters&>(*this) = SearchCounters();
+        source = Source::None;
+        seconds = 0.0;
+        rootMoveCount = 0;
+    }
+
+    // New entry for cell, or nullptr once the list is full
+    RootMoveStats* AddRootMove(int cell) {
+        if (rootMoveCount == MAX_ROOT_MOVES) {
+            return nullptr;
+        }
+        RootMoveStats& added = rootMoves[rootMoveCount++];
+        added = RootMoveStats();
+        added.cell = cell;
+        return &added;
+    }
+};
+
+// Search tracing. Build with -DXO_SEARCH_TRACE to have the searches report every node
+// to a SearchTraceSink; without it the SEARCH_TRACE calls compile to nothing, so the
+// sink costs nothing in normal builds. Every file must be built the same way.
+enum class SearchTraceKind : uint8_t {
+    Node,       // Entered a position
+    Leaf,       // Scored a position without expanding it
+    TableHit,   // Found a position in the transposition table
+    Cutoff,     // cell refuted the position; score is the value that cut it off
+    RootMove,   // Finished a root move (cell) with score
+    Iteration   // Finished an iteration of iterative deepening; ply is its depth, cell its best move
+};
+
+struct SearchTraceEvent {
+    SearchTraceKind kind;
+    int ply;        // Plies below the root
+    int cell;       // Move concerned, or -1
+    int score;      // RootMove and Iteration: for the searching side. Others as the search keeps
+                    // them: for the side to move at ply on larger boards, for the AI on 3x3.
+};
+
+// Receives trace events on the thread running the search; only the main thread of a
+// multi-threaded search reports
+class SearchTraceSink {
+public:
+    virtual ~SearchTraceSink() = default;
+    virtual void Trace(const SearchTraceEvent& event) = 0;
+};
+
+#ifdef XO_SEARCH_TRACE
+constexpr bool SEARCH_TRACE_ENABLED = true;
+#define SEARCH_TRACE(sink, kind, ply, cell, score) \
+    do { \
+        if (sink) { \
+            (sink)->Trace(SearchTraceEvent{SearchTraceKind::kind, (ply), (cell), (score)}); \
+        } \
+    } while (0)
+#else
+constexpr bool SEARCH_TRACE_ENABLED = false;
+#define SEARCH_TRACE(sink, kind, ply, cell, score) ((void)0)
+#endif
@@ -0,0 +1,213 @@
+#include "ai_player.h"
+#include "game_core.h"
+#include "game_record.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plays AI against AI on 3x3 without the GUI's move timer and reports the results,
+// for measuring and tuning the difficulty levels.
+//
+// Usage: self_play [--games N] [--threads T] [--seed S] [--playouts P] [--alternate] [--record FILE]
+//                  PLAYER_A PLAYER_B
+//   PLAYER_A and PLAYER_B are easy, normal, hard or mcts. A plays X unless --alternate
+//   swaps sides every other game. mcts runs P playouts per move (default 1000).
+//   --record saves every game to FILE in the game record format (game_record.h).
+
+struct Tally {
+    uint64_t aWins = 0;
+    uint64_t draws = 0;
+    uint64_t bWins = 0;
+    uint64_t aWinsAsX = 0;
+    uint64_t bWinsAsX = 0;
+    ArenaStats searchMemory;    // The thread's MonteCarlo tree pool
+};
+
+static bool ParseDifficulty(const char* name, AIPlayer::Difficulty& difficulty) {
+    if (std::strcmp(name, "easy") == 0) {
+        difficulty = AIPlayer::Difficulty::Easy;
+    } else if (std::strcmp(name, "normal") == 0) {
+        difficulty = AIPlayer::Difficulty::Normal;
+    } else if (std::strcmp(name, "hard") == 0) {
+        difficulty = AIPlayer::Difficulty::Hard;
+    } else if (std::strcmp(name, "mcts") == 0) {
+        difficulty = AIPlayer::Difficulty::MonteCarlo;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Plays games [first, first + count) of the run; game i's sides depend only on i.
+// Finished games go to writer when it is not null.
+static Tally PlayGames(uint64_t first, uint64_t count, AIPlayer::Difficulty a, AIPlayer::Difficulty b, 
+                       bool alternate, uint32_t seed, uint64_t playouts, GameRecordWriter* writer) {
+    AIPlayer ai;
+    ai.SetSeed(seed);
+    ai.SetPlayoutBudget(playouts);
+    GameCore game;
+    Tally tally;
+    
+    std::unique_ptr<GameRecordBuffer> records;
+    GameRecord record;
+    if (writer) {
+        records = std::make_unique<GameRecordBuffer>(*writer);
+    }
+    
+    for (uint64_t i = first; i < first + count; i++) {
+        bool aIsX = !alternate || (i & 1) == 0;
+        AIPlayer::Difficulty xLevel = aIsX ? a : b;
+        AIPlayer::Difficulty oLevel = aIsX ? b : a;
+        
+        game.Start(PlayerType::AI, PlayerType::AI);
+        while (!game.IsOver()) {
+            Mark toMove = game.CurrentPlayer();
+            std::pair<int, int> move = ai.GetBestMove(game.Board(), toMove, (toMove == Mark::X) ? xLevel : oLevel);
+            if (!game.Play(move.first, move.second)) {
+                std::fprintf(stderr, "Illegal move (%d, %d) in game %llu\n", move.first, move.second, 
+                             (unsigned long long)i);
+                std::exit(1);
+            }
+        }
+        
+        if (records) {
+            game.Record(record);
+            records->Append(record);
+        }
+        
+        GameResult result = game.Result();
+        if (result == GameResult::Draw) {
+            tally.draws++;
+        } else if ((result == GameResult::XWon) == aIsX) {
+            tally.aWins++;
+            tally.aWinsAsX += aIsX;
+        } else {
+            tally.bWins++;
+            tally.bWinsAsX += !aIsX;
+        }
+    }
+    
+    tally.searchMemory = ai.SearchMemory();
+    return tally;
+}
+
+static void PrintUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [--games N] [--threads T] [--seed S] [--playouts P] [--alternate] "
+                         "[--record FILE] easy|normal|hard|mcts easy|normal|hard|mcts\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t games = 1000000;
+    int threads = (int)std::thread::hardware_concurrency();
+    uint32_t seed = (uint32_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    uint64_t playouts = 1000;
+    bool alternate = false;
+    const char* recordPath = nullptr;
+    const char* names[2] = {nullptr, nullptr};
+    int nameCount = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--playouts") == 0 && i + 1 < argc) {
+            playouts = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--alternate") == 0) {
+            alternate = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (argv[i][0] != '-' && nameCount < 2) {
+            names[nameCount++] = argv[i];
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    AIPlayer::Difficulty levels[2];
+    if (nameCount != 2 || !ParseDifficulty(names[0], levels[0]) || !ParseDifficulty(names[1], levels[1])) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    
+    GameRecordWriter writer;
+    if (recordPath && !writer.Open(recordPath, GameCore::GRID_SIZE, GameCore::GRID_SIZE)) {
+        std::fprintf(stderr, "Cannot create %s\n", recordPath);
+        return 1;
+    }
+    
+    // Each thread gets a contiguous share of the games and its own player, seed and record buffer
+    std::vector<Tally> tallies(threads);
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    
+    uint64_t first = 0;
+    for (int t = 0; t < threads; t++) {
+        uint64_t count = games / threads + ((uint64_t)t < games % threads ? 1 : 0);
+        workers.emplace_back([&tallies, &levels, &writer, t, first, count, alternate, seed, playouts]() {
+            tallies[t] = PlayGames(first, count, levels[0], levels[1], alternate, seed + (uint32_t)t, playouts, 
+                                   writer.IsOpen() ? &writer : nullptr);
+        });
+        first += count;
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    bool recorded = writer.Close();
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    Tally total;
+    size_t peakMemory = 0;
+    for (const Tally& tally : tallies) {
+        peakMemory = std::max(peakMemory, tally.searchMemory.peak);
+        total.searchMemory += tally.searchMemory;
+        total.aWins += tally.aWins;
+        total.draws += tally.draws;
+        total.bWins += tally.bWins;
+        total.aWinsAsX += tally.aWinsAsX;
+        total.bWinsAsX += tally.bWinsAsX;
+    }
+    
+    auto percent = [games](uint64_t count) { return games ? 100.0 * count / games : 0.0; };
+    
+    std::printf("%llu games, %s vs %s, %d threads, seed %u%s\n", (unsigned long long)games, names[0], names[1], 
+                threads, seed, alternate ? ", alternating sides" : ", A plays X");
+    std::string aLabel = std::string("A (") + names[0] + ") wins";
+    std::string bLabel = std::string("B (") + names[1] + ") wins";
+    std::printf("%-16s %12llu %6.2f%%  (%llu as X)\n", aLabel.c_str(), (unsigned long long)total.aWins, 
+                percent(total.aWins), (unsigned long long)total.aWinsAsX);
+    std::printf("%-16s %12llu %6.2f%%\n", "Draws", (unsigned long long)total.draws, percent(total.draws));
+    std::printf("%-16s %12llu %6.2f%%  (%llu as X)\n", bLabel.c_str(), (unsigned long long)total.bWins, 
+                percent(total.bWins), (unsigned long long)total.bWinsAsX);
+    std::printf("%.3f s, %.0f games/s\n", seconds, games / seconds);
+    if (recordPath) {
+        if (!recorded) {
+            std::fprintf(stderr, "Writing %s failed\n", recordPath);
+            return 1;
+        }
+        std::printf("Recorded %llu games to %s, %llu bytes (%.2f bytes/game)\n", 
+                    (unsigned long long)writer.GamesWritten(), recordPath, (unsigned long long)writer.BytesWritten(), 
+                    games ? (double)writer.BytesWritten() / games : 0.0);
+    }
+    if (total.searchMemory.capacity > 0) {
+        std::printf("Search arenas: peak %.1f KB per thread (reserved %.1f KB), %.1f KB over all threads\n", 
+                    peakMemory / 1024.0, total.searchMemory.capacity / 1024.0 / threads, 
+                    total.searchMemory.peak / 1024.0);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,1054 @@
+#include "ai_player.h"
+#include "alloc_counter.h"
+#include "arena.h"
+#include "board_status.h"
+#include "frame_stats.h"
+#include "game_core.h"
+#include "game_record.h"
+#include "game_search.h"
+#include "move_list.h"
+#include "opening_book.h"
+#include "perfect_play.h"
+#include "pixel_renderer.h"
+#include "scene_model.h"
+#include "scene_painter.h"
+#include "ui_layout.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Solves every reachable 3x3 position with the generic engine on Board and
+// counts disagreements with the perfect-play table
+template <typename Board>
+static int VerifyGenericEngine(int threads = 1) {
+    TranspositionTable table(16);
+    GameSearch<Board> search(table);
+    
+    std::vector<bool> visited(POSITION_KEYS, false);
+    std::vector<Bitboard> pending = {Bitboard{}};
+    int mismatches = 0;
+    
+    while (!pending.empty()) {
+        Bitboard position = pending.back();
+        pending.pop_back();
+        
+        if (visited[position.Key()]) {
+            continue;
+        }
+        visited[position.Key()] = true;
+        
+        Mark toMove = position.ToMove();
+        if (position.HasWon(Opponent(toMove)) || position.IsFull()) {
+            continue;
+        }
+        
+        // Replay the position onto the board type under test
+        Board board;
+        for (int cell = 0; cell < BOARD_CELLS; cell++) {
+            if (position.Has(cell, Mark::X)) {
+                board.Place(cell, Mark::X);
+            } else if (position.Has(cell, Mark::O)) {
+                board.Place(cell, Mark::O);
+            }
+        }
+        
+        // Ties may be broken differently, so check the move is one of the optimal ones:
+        // it must reach a position the table values the same as this one
+        SearchLimits limits;
+        limits.threads = threads;
+        SearchResult result = search.Search(board, limits);
+        int cell = result.cell;
+        int score = result.score;
+        const PerfectPlayEntry& entry = LookupPerfectPlay(position);
+        if (cell < 0 || !position.IsEmpty(cell) ||
+            -LookupPerfectPlay(position.Play(cell, toMove)).value != entry.value ||
+            (score > 0) != (entry.value > 0) || (score < 0) != (entry.value < 0)) {
+            mismatches++;
+        }
+        
+        for (uint16_t empty = position.EmptyCells(); empty; empty &= empty - 1) {
+            pending.push_back(position.Play(LowestCell(empty), toMove));
+        }
+    }
+    
+    return mismatches;
+}
+
+// Background searches deliver the same move as GetBestMove, and a cancelled search
+// stops promptly without calling back. Returns the number of failed checks.
+static int VerifyAsyncSearch() {
+    int failures = 0;
+    AIPlayer ai;
+    
+    // Position where X must block at cell 2
+    Bitboard board = Bitboard{}.Play(4, Mark::X).Play(0, Mark::O).Play(8, Mark::X).Play(1, Mark::O);
+    std::pair<int, int> expected = ai.GetBestMove(board, Mark::X);
+    
+    std::promise<std::pair<int, int>> delivered;
+    ai.GetBestMoveAsync(board, Mark::X, AIPlayer::Difficulty::Hard,
+                        [&delivered](std::pair<int, int> move) { delivered.set_value(move); });
+    if (delivered.get_future().get() != expected || expected != std::pair<int, int>{0, 2}) {
+        failures++;
+    }
+    
+    // A long search on a big board, cancelled shortly after it starts
+    std::atomic<bool> calledBack{false};
+    ai.SetTimeBudget(std::chrono::milliseconds(60000));
+    ai.GetBestMoveAsync(GridBoard<15, 5>(), Mark::X, AIPlayer::Difficulty::Hard,
+                        [&calledBack](std::pair<int, int>) { calledBack = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    
+    auto start = std::chrono::steady_clock::now();
+    ai.CancelSearch();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    if (calledBack || elapsed > std::chrono::seconds(1)) {
+        failures++;
+    }
+    
+    return failures;
+}
+
+// Scripted games through GameCore: results, turn order, illegal moves and undo.
+// Returns the number of failed checks.
+static int VerifyGameCore() {
+    int failures = 0;
+    GameCore game;
+    game.Start(PlayerType::Human, PlayerType::AI);
+    
+    // X takes the main diagonal while O plays the top row
+    const int moves[][2] = {{0, 0}, {0, 1}, {1, 1}, {0, 2}};
+    for (const auto& move : moves) {
+        failures += !game.Play(move[0], move[1]);
+    }
+    failures += game.Play(0, 1);                    // Taken
+    failures += game.Play(3, 0);                    // Off the board
+    failures += game.CurrentPlayer() != Mark::X || game.IsAITurn();
+    failures += !game.Play(2, 2) || game.Result() != GameResult::XWon;
+    failures += game.Play(2, 0);                    // Game over
+    
+    // Undo reopens the game with the winner to move again
+    failures += !game.Undo() || game.Result() != GameResult::Playing || game.CurrentPlayer() != Mark::X;
+    failures += game.MoveCount() != 4 || game.MoveAt(3) != 2;
+    
+    // A drawn game: X O X / X O O / O X X
+    game.Reset();
+    const int drawn[] = {0, 1, 2, 4, 3, 5, 7, 6, 8};
+    for (int cell : drawn) {
+        failures += !game.Play(cell / 3, cell % 3);
+    }
+    failures += game.Result() != GameResult::Draw || game.MoveCount() != 9;
+    
+    return failures;
+}
+
+// Every legal 3x3 position with moves left, X moving first, in base-3 key order
+static std::vector<Bitboard> PlayablePositions() {
+    std::vector<Bitboard> positions;
+    for (int key = 0; key < POSITION_KEYS; key++) {
+        Bitboard board;
+        for (int cell = 0, rest = key; cell < BOARD_CELLS; cell++, rest /= 3) {
+            if (rest % 3 == 1) {
+                board.Place(cell, Mark::X);
+            } else if (rest % 3 == 2) {
+                board.Place(cell, Mark::O);
+            }
+        }
+        int balance = PopCount(board.x) - PopCount(board.o);
+        if (balance >= 0 && balance <= 1 && !board.HasWon(Mark::X) && !board.HasWon(Mark::O) && !board.IsFull()) {
+            positions.push_back(board);
+        }
+    }
+    return positions;
+}
+
+// GetBestMove at every difficulty, on every 3x3 position and along a 7x7 game, must not
+// touch the heap once the player's tables exist. Returns the number of calls that allocated.
+static int VerifyAllocationFree() {
+    AIPlayer ai;
+    ai.SetSeed(1);
+    ai.SetTimeBudget(std::chrono::milliseconds(5));
+    ai.SetPlayoutBudget(100);
+    const AIPlayer::Difficulty levels[] = {
+        AIPlayer::Difficulty::Easy, AIPlayer::Difficulty::Normal, AIPlayer::Difficulty::Hard, 
+        AIPlayer::Difficulty::MonteCarlo
+    };
+    int failures = 0;
+    
+    auto countCall = [&failures](auto&& call) {
+        uint64_t before = AllocationCount();
+        call();
+        failures += (AllocationCount() != before);
+    };
+    
+    // The MonteCarlo tree is allocated by the first search
+    ai.GetBestMove(Bitboard(), Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    
+    for (const Bitboard& board : PlayablePositions()) {
+        for (AIPlayer::Difficulty level : levels) {
+            countCall([&]() { ai.GetBestMove(board, board.ToMove(), level); });
+        }
+    }
+    
+    // The larger-board table is allocated by its first search; the MonteCarlo tree's
+    // pool serves every board type, so switching boards allocates nothing
+    GridBoard<7, 4> grid;
+    ai.GetBestMove(grid, Mark::X, AIPlayer::Difficulty::Hard);
+    for (int ply = 0; ply < 8; ply++) {
+        Mark toMove = grid.ToMove();
+        std::pair<int, int> move;
+        countCall([&]() { move = ai.GetBestMove(grid, toMove, levels[(ply + 3) % 4]); });
+        grid.Place(move.first * 7 + move.second, toMove);
+    }
+    countCall([&]() { ai.GetBestMove(Bitboard(), Mark::X, AIPlayer::Difficulty::MonteCarlo); });
+    
+    return failures;
+}
+
+// Batch evaluation on 4 threads must match the perfect-play table: exactly for 3x3
+// boards, and up to tie-breaks for the generic search. Returns the number of mismatches.
+static int VerifyBatchEvaluation() {
+    std::vector<Bitboard> positions = PlayablePositions();
+    
+    AIPlayer ai;
+    ai.SetThreadCount(4);
+    std::vector<int> cells(positions.size());
+    std::vector<int> scores(positions.size());
+    int mismatches = 0;
+    
+    ai.EvaluateBatch(positions.data(), positions.size(), cells.data(), scores.data());
+    for (size_t i = 0; i < positions.size(); i++) {
+        const PerfectPlayEntry& entry = LookupPerfectPlay(positions[i]);
+        mismatches += (cells[i] != entry.cell || scores[i] != entry.value);
+    }
+    
+    std::vector<GridBoard<3, 3>> grids(positions.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        for (int cell = 0; cell < BOARD_CELLS; cell++) {
+            if (positions[i].Has(cell, Mark::X)) {
+                grids[i].Place(cell, Mark::X);
+            } else if (positions[i].Has(cell, Mark::O)) {
+                grids[i].Place(cell, Mark::O);
+            }
+        }
+    }
+    
+    ai.EvaluateBatch(grids.data(), grids.size(), cells.data(), scores.data());
+    for (size_t i = 0; i < positions.size(); i++) {
+        const Bitboard& position = positions[i];
+        int value = LookupPerfectPlay(position).value;
+        int cell = cells[i];
+        if (cell < 0 || !position.IsEmpty(cell) ||
+            -LookupPerfectPlay(position.Play(cell, position.ToMove())).value != value ||
+            (scores[i] > 0) != (value > 0) || (scores[i] < 0) != (value < 0)) {
+            mismatches++;
+        }
+    }
+    
+    return mismatches;
+}
+
+// The vectorized status kernel must agree with the scalar one on all 3^9 boards, legal
+// or not, for every batch length up to 40 so each tail size is covered.
+// Returns the number of mismatching boards.
+static int VerifyBoardStatusBatch() {
+    std::vector<Bitboard> boards(POSITION_KEYS);
+    for (int key = 0; key < POSITION_KEYS; key++) {
+        for (int cell = 0, rest = key; cell < BOARD_CELLS; cell++, rest /= 3) {
+            if (rest % 3 == 1) {
+                boards[key].Place(cell, Mark::X);
+            } else if (rest % 3 == 2) {
+                boards[key].Place(cell, Mark::O);
+            }
+        }
+    }
+    
+    std::vector<BoardStatus> expected(boards.size());
+    std::vector<BoardStatus> actual(boards.size());
+    GetBoardStatusBatchScalar(boards.data(), boards.size(), expected.data());
+    GetBoardStatusBatch(boards.data(), boards.size(), actual.data());
+    
+    int mismatches = 0;
+    for (size_t i = 0; i < boards.size(); i++) {
+        mismatches += (actual[i] != expected[i]);
+    }
+    
+    for (size_t count = 1; count <= 40; count++) {
+        size_t offset = count * 97;
+        GetBoardStatusBatch(boards.data() + offset, count, actual.data());
+        for (size_t i = 0; i < count; i++) {
+            mismatches += (actual[i] != expected[offset + i]);
+        }
+    }
+    
+    return mismatches;
+}
+
+// MonteCarlo with 10000 playouts must never lose to the perfect player on 3x3, the
+// tree must carry over between moves until a new game, a small node limit must cap
+// the tree, and one too small for the root's children must still give a legal move.
+// Returns the number of failed checks.
+static int VerifyMonteCarlo() {
+    AIPlayer mcts;
+    AIPlayer perfect;
+    mcts.SetSeed(7);
+    mcts.SetPlayoutBudget(10000);
+    int failures = 0;
+    
+    for (int game = 0; game < 20; game++) {
+        Mark mctsSide = (game & 1) ? Mark::O : Mark::X;
+        GameCore core;
+        while (!core.IsOver()) {
+            Mark toMove = core.CurrentPlayer();
+            std::pair<int, int> move = (toMove == mctsSide) 
+                ? mcts.GetBestMove(core.Board(), toMove, AIPlayer::Difficulty::MonteCarlo)
+                : perfect.GetBestMove(core.Board(), toMove, AIPlayer::Difficulty::Hard);
+            if (!core.Play(move.first, move.second)) {
+                failures++;
+                break;
+            }
+        }
+        failures += (core.Result() == ((mctsSide == Mark::X) ? GameResult::OWon : GameResult::XWon));
+    }
+    
+    // The next search after our move and a reply starts from the kept subtree; a new game does not
+    GridBoard<5, 4> grid;
+    mcts.SetPlayoutBudget(3000);
+    std::pair<int, int> first = mcts.GetBestMove(grid, Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    grid.Place(first.first * 5 + first.second, Mark::X);
+    grid.Place(grid.NextEmpty(0), Mark::O);
+    mcts.GetBestMove(grid, Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    failures += (mcts.LastMctsResult().reusedVisits == 0 || mcts.LastMctsResult().reusedVisits >= 3000);
+    mcts.NewGame();
+    mcts.GetBestMove(grid, Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    failures += (mcts.LastMctsResult().reusedVisits != 0 || mcts.LastMctsResult().playouts != 3000);
+    
+    // A 7x7 search against a 1000-node ceiling fills the pool without exceeding it
+    mcts.SetMctsNodeLimit(1000);
+    mcts.SetPlayoutBudget(5000);
+    std::pair<int, int> move = mcts.GetBestMove(GridBoard<7, 4>(), Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    const MctsResult& result = mcts.LastMctsResult();
+    failures += (move.first < 0 || !result.poolFull || result.nodes > 1000 || result.playouts != 5000);
+    
+    // Its pool is all it holds, and the peak stays under that
+    ArenaStats memory = mcts.SearchMemory();
+    failures += (memory.capacity != 1000 * sizeof(MctsNode) ||
+                 memory.peak < result.nodes * sizeof(MctsNode) || memory.peak > memory.capacity);
+    
+    // With that pool full, the subtree after our move and a reply is compacted in place:
+    // its visits carry over and the tree still fits
+    GridBoard<7, 4> full;
+    full.Place(move.first * 7 + move.second, Mark::X);
+    full.Place(full.NextEmpty(0), Mark::O);
+    mcts.GetBestMove(full, Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    failures += (result.reusedVisits == 0 || result.reusedNodes > 1000 || result.nodes > 1000 || 
+                 result.playouts + result.reusedVisits != 5000);
+    
+    // A pool too small to expand the root still answers with a legal move
+    mcts.SetMctsNodeLimit(5);
+    mcts.NewGame();
+    std::pair<int, int> tiny = mcts.GetBestMove(Bitboard(), Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    failures += (tiny.first < 0 || tiny.first >= 3 || tiny.second < 0 || tiny.second >= 3 || 
+                 !mcts.LastMctsResult().poolFull);
+    tiny = mcts.GetBestMove(full, Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    failures += (tiny.first < 0 || !full.IsEmpty(tiny.first * 7 + tiny.second));
+    
+    return failures;
+}
+
+// Arena allocations must be aligned, fail cleanly when full, and be released by
+// Rewind and Reset while the peak is remembered. Returns the number of failed checks.
+static int VerifyArena() {
+    Arena arena(64);
+    int failures = 0;
+    
+    uint8_t* byte = arena.Allocate<uint8_t>(3);
+    uint64_t* words = arena.Allocate<uint64_t>(4);
+    failures += (!byte || !words || (uintptr_t)words % alignof(uint64_t) != 0 || arena.Used() != 40);
+    failures += (words[0] != 0 || words[3] != 0);
+    
+    failures += (arena.Allocate<uint64_t>(4) != nullptr || arena.Used() != 40);
+    failures += (arena.Allocate<uint32_t>(6) == nullptr || arena.Used() != 64);
+    arena.Rewind(40);
+    failures += (arena.Used() != 40 || arena.Stats().peak != 64);
+    
+    arena.Reset();
+    arena.ResetPeak();
+    failures += (arena.Used() != 0 || arena.Stats().peak != 0 || arena.Allocate<uint64_t>(8) == nullptr);
+    
+    return failures;
+}
+
+// A book written for 4x4 must map back with every record findable by hash, steer
+// Hard's move on the board size it covers, and be refused when truncated.
+// Returns the number of failed checks.
+static int VerifyOpeningBook() {
+    const char* path = "selfcheck_book.tmp";
+    
+    // Arbitrary moves rather than searched ones, so a hit can only come from the book
+    std::vector<GridBoard<4, 4>> positions(1);
+    std::vector<BookEntry> entries;
+    for (int cell = 0; cell < 16; cell++) {
+        positions.emplace_back();
+        positions.back().Place(cell, Mark::X);
+    }
+    for (size_t i = 0; i < positions.size(); i++) {
+        int cell = (int)(i * 7 + 3) % 16;
+        while (!positions[i].IsEmpty(cell)) {
+            cell = (cell + 1) % 16;
+        }
+        entries.push_back(BookEntry{positions[i].Hash(), BookRecord{(int16_t)cell, (int16_t)i, 1, 0}});
+    }
+    entries.push_back(entries[3]);
+    
+    int failures = !WriteOpeningBook(path, 4, 4, entries);
+    
+    OpeningBook book;
+    failures += (!book.Open(path) || book.Count() != positions.size() || !book.Covers(4, 4) || book.Covers(5, 4));
+    
+    // The player maps the file too, until it goes out of scope
+    {
+        AIPlayer ai;
+        failures += !ai.LoadBook(path);
+        for (size_t i = 0; i < positions.size() && book.IsOpen(); i++) {
+            const BookRecord* record = book.Find(positions[i].Hash());
+            failures += (!record || record->cell != entries[i].record.cell || record->score != (int16_t)i);
+            
+            std::pair<int, int> move = ai.GetBestMove(positions[i], positions[i].ToMove(), AIPlayer::Difficulty::Hard);
+            failures += (move.first * 4 + move.second != entries[i].record.cell);
+        }
+    }
+    GridBoard<4, 4> missing = positions[1];
+    missing.Place(15, Mark::O);
+    failures += (book.Find(missing.Hash()) != nullptr);
+    
+    // Both mappings are closed before the files are touched again: Windows refuses to
+    // remove a mapped file. The copy one byte short of the length the header promises
+    // goes to a file of its own.
+    book.Close();
+    const char* shortPath = "selfcheck_book_short.tmp";
+    std::FILE* file = std::fopen(path, "rb");
+    std::vector<char> bytes(sizeof(BookHeader) + positions.size() * (sizeof(uint64_t) + sizeof(BookRecord)) - 1);
+    failures += (!file || std::fread(bytes.data(), 1, bytes.size(), file) != bytes.size());
+    if (file) {
+        std::fclose(file);
+    }
+    file = std::fopen(shortPath, "wb");
+    failures += (!file || std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size());
+    if (file) {
+        std::fclose(file);
+    }
+    {
+        OpeningBook truncated;
+        failures += truncated.Open(shortPath);
+    }
+    
+    std::remove(path);
+    std::remove(shortPath);
+    return failures;
+}
+
+// Games written from several threads must all read back intact: 3x3 games in the
+// nibble encoding, including repeats that share their whole move list, and long
+// 7x7 games in the varint encoding across many blocks. A truncated file must
+// report damage rather than end quietly. Returns the number of failed checks.
+static int VerifyGameRecords() {
+    const char* path = "selfcheck_games.tmp";
+    int failures = 0;
+    
+    // Every playable 3x3 position as an unfinished game; every other one is then finished
+    // by perfect play, so many games share their openings
+    std::vector<GameRecord> games;
+    AIPlayer ai;
+    for (const Bitboard& position : PlayablePositions()) {
+        GameCore game;
+        game.Start(PlayerType::AI, PlayerType::AI);
+        uint16_t stones[2] = {position.x, position.o};
+        while (stones[0] | stones[1]) {
+            uint16_t& mine = stones[(int)game.CurrentPlayer()];
+            int cell = LowestCell(mine);
+            mine &= mine - 1;
+            game.Play(cell / 3, cell % 3);
+        }
+        while (games.size() % 2 == 0 && !game.IsOver()) {
+            std::pair<int, int> move = ai.GetBestMove(game.Board(), game.CurrentPlayer(), AIPlayer::Difficulty::Hard);
+            game.Play(move.first, move.second);
+        }
+        games.emplace_back();
+        game.Record(games.back());
+    }
+    
+    // Thread t writes games t, t + threads, ... twice over, each through its own buffer
+    const int threads = 4;
+    std::vector<std::vector<size_t>> order(threads);
+    for (int repeat = 0; repeat < 2; repeat++) {
+        for (size_t i = 0; i < games.size(); i++) {
+            order[i % threads].push_back(i);
+        }
+    }
+    
+    GameRecordWriter writer;
+    failures += !writer.Open(path, 3, 3);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&writer, &games, &order, t]() {
+            GameRecordBuffer buffer(writer);
+            for (size_t index : order[t]) {
+                buffer.Append(games[index]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    failures += !writer.Close();
+    failures += (writer.GamesWritten() != 2 * games.size());
+    
+    // Blocks from different threads interleave, but each thread's games stay in order
+    GameRecordReader reader;
+    failures += (!reader.Open(path) || reader.BoardSize() != 3);
+    std::vector<size_t> next(threads, 0);
+    size_t count = 0;
+    while (const GameRecord* record = reader.Next()) {
+        bool matched = false;
+        for (int t = 0; t < threads && !matched; t++) {
+            if (next[t] < order[t].size() && *record == games[order[t][next[t]]]) {
+                next[t]++;
+                matched = true;
+            }
+        }
+        failures += !matched;
+        count++;
+    }
+    failures += (reader.Failed() || count != 2 * games.size());
+    
+    // Random 7x7 games are long enough to need several blocks and varints
+    std::vector<GameRecord> longGames(2000);
+    uint64_t random = 99;
+    for (GameRecord& record : longGames) {
+        GridBoard<7, 4> board;
+        while (!board.HasWon(Mark::X) && !board.HasWon(Mark::O) && !board.IsFull()) {
+            int cell = (int)(SplitMix64(random) % 49);
+            if (board.IsEmpty(cell)) {
+                board.Place(cell, board.ToMove());
+                record.Add(cell);
+            }
+        }
+        record.result = board.HasWon(Mark::X) ? GameResult::XWon : 
+                        board.HasWon(Mark::O) ? GameResult::OWon : GameResult::Draw;
+    }
+    
+    failures += !writer.Open(path, 7, 4);
+    {
+        GameRecordBuffer buffer(writer);
+        for (const GameRecord& record : longGames) {
+            buffer.Append(record);
+        }
+    }
+    failures += !writer.Close();
+    uint64_t bytes = writer.BytesWritten();
+    
+    failures += (!reader.Open(path) || reader.BoardSize() != 7 || reader.WinLength() != 4);
+    count = 0;
+    while (const GameRecord* record = reader.Next()) {
+        failures += (count >= longGames.size() || *record != longGames[count]);
+        count++;
+    }
+    failures += (reader.Failed() || count != longGames.size());
+    reader.Close();
+    
+    // Cut into the last block
+    std::FILE* file = std::fopen(path, "rb");
+    std::vector<char> data(bytes - 3);
+    failures += (!file || std::fread(data.data(), 1, data.size(), file) != data.size());
+    if (file) {
+        std::fclose(file);
+    }
+    file = std::fopen(path, "wb");
+    failures += (!file || std::fwrite(data.data(), 1, data.size(), file) != data.size());
+    if (file) {
+        std::fclose(file);
+    }
+    failures += !reader.Open(path);
+    while (reader.Next()) {
+    }
+    failures += !reader.Failed();
+    reader.Close();
+    
+    std::remove(path);
+    return failures;
+}
+
+static int VerifyMoveLists() {
+    int failures = 0;
+    
+    // Every playable position but the empty board written as a line and parsed back
+    std::string text = "# header comment\n\n";
+    std::vector<GameRecord> games;
+    for (const Bitboard& position : PlayablePositions()) {
+        GameCore game;
+        game.Start(PlayerType::Human, PlayerType::Human);
+        uint16_t stones[2] = {position.x, position.o};
+        while (stones[0] | stones[1]) {
+            uint16_t& mine = stones[(int)game.CurrentPlayer()];
+            int cell = LowestCell(mine);
+            mine &= mine - 1;
+            game.Play(cell / 3, cell % 3);
+        }
+        if (position.x | position.o) {
+            games.emplace_back();
+            game.Record(games.back());
+            AppendMoveListLine(games.back(), text);
+        }
+    }
+    
+    // Separators, comments and line endings around games that must still parse
+    text += "0, 3,\t1 4 2  # X wins\r\n";
+    text += "4 0 8 2 1 7 6 3 5";
+    const int extraGames = 2;
+    
+    // Lines that are not games: a cell off the board, a bad character, too many moves.
+    // Legality is left to whoever replays the game.
+    const char* invalid[] = {"0 9\n", "0 1 x\n", "0 1 2 3 4 5 6 7 8 0\n"};
+    
+    const char* cursor = text.data();
+    const char* end = text.data() + text.size();
+    size_t count = 0;
+    GameRecord record;
+    MoveListLine kind;
+    while (cursor < end) {
+        cursor = ParseMoveListLine(cursor, end, record, kind);
+        if (kind == MoveListLine::Game) {
+            if (count < games.size()) {
+                failures += (record.moveCount != games[count].moveCount ||
+                             !std::equal(record.moves.begin(), record.moves.begin() + record.moveCount,
+                                         games[count].moves.begin()));
+            }
+            count++;
+        } else {
+            failures += (kind != MoveListLine::Blank);
+        }
+    }
+    failures += (count != games.size() + extraGames);
+    failures += (record.moveCount != 9 || record.moves[0] != 4 || record.moves[8] != 5);
+    
+    for (const char* line : invalid) {
+        const char* lineEnd = line + std::char_traits<char>::length(line);
+        failures += (ParseMoveListLine(line, lineEnd, record, kind) != lineEnd || kind != MoveListLine::Invalid);
+    }
+    
+    return failures;
+}
+
+// Frames drawn through PixelRenderer must be repeatable and, once the buffer and sprites
+// exist, cost no allocations. Returns the number of failures.
+static int VerifyFrameRendering() {
+    int failures = 0;
+    PixelRenderer renderer;
+    renderer.Resize(UiLayout::WINDOW_WIDTH, UiLayout::WINDOW_HEIGHT);
+    const Color* pixels = renderer.Pixels();
+    UiLayout layout;
+    
+    GameCore game;
+    game.Start(PlayerType::Human, PlayerType::Human);
+    game.Play(1, 1);
+    game.Play(0, 0);
+    SceneState scene;
+    scene.screen = GameScreen::Game;
+    scene.game = &game;
+    scene.statusText = L"Player X's turn (Human)";
+    
+    layout.Update(scene);
+    ScenePainter::Paint(renderer, scene, layout);
+    uint64_t first = renderer.Checksum();
+    
+    // Same scene, same pixels; the hovered cell changes them
+    uint64_t before = AllocationCount();
+    ScenePainter::Paint(renderer, scene, layout);
+    failures += (AllocationCount() != before);
+    failures += (renderer.Checksum() != first);
+    scene.hoverRow = 2;
+    scene.hoverCol = 2;
+    ScenePainter::Paint(renderer, scene, layout);
+    failures += (renderer.Checksum() == first);
+    failures += (renderer.Pixel(UiLayout::BOARD_LEFT + 2 * UiLayout::CELL_SIZE + 5,
+                                UiLayout::BOARD_TOP + 2 * UiLayout::CELL_SIZE + 5) != MakeColor(235, 245, 255));
+    
+    // Resizing to the same size keeps the buffer
+    renderer.Resize(UiLayout::WINDOW_WIDTH, UiLayout::WINDOW_HEIGHT);
+    failures += (renderer.Pixels() != pixels);
+    
+    // Blending white over black at half opacity gives mid grey
+    PixelRenderer small;
+    small.Resize(2, 2);
+    small.FillRect({0, 0, 2, 2}, MakeColor(0, 0, 0));
+    small.Blend({0, 0, 1, 1}, MakeColor(255, 255, 255), 128);
+    failures += (small.Pixel(0, 0) != MakeColor(128, 128, 128) || small.Pixel(1, 1) != 0);
+    
+    return failures;
+}
+
+// Layouts must be built without allocating, and the bucketed hit-test must agree with
+// a scan of every widget at every pixel. Returns the number of failures.
+static int VerifyWidgetLayout() {
+    int failures = 0;
+    UiLayout layout;
+    GameCore game;
+    game.Start(PlayerType::Human, PlayerType::AI);
+    SceneState scene;
+    scene.game = &game;
+    
+    auto checkHits = [&]() {
+        for (int y = -1; y <= UiLayout::WINDOW_HEIGHT; y++) {
+            for (int x = -1; x <= UiLayout::WINDOW_WIDTH; x++) {
+                const Widget* expected = nullptr;
+                for (const Widget& widget : layout) {
+                    const Rect& hit = widget.hitRect;
+                    if (x >= hit.left && x < hit.right && y >= hit.top && y < hit.bottom) {
+                        expected = &widget;
+                        break;
+                    }
+                }
+                failures += (layout.HitTest(x, y) != expected);
+            }
+        }
+    };
+    
+    // The welcome screen has eight buttons while an AI plays, five without one; button
+    // edges are included as they always were
+    uint64_t before = AllocationCount();
+    failures += !layout.Update(scene);
+    failures += (AllocationCount() != before);
+    failures += layout.Update(scene);
+    failures += (layout.ButtonCount() != 8);
+    checkHits();
+    const Widget& start = layout.Button(7);
+    failures += (start.action != UiAction::StartGame);
+    failures += (layout.HitTest(start.rect.right, start.rect.bottom) != &start);
+    scene.oPlayerType = PlayerType::Human;
+    failures += !layout.Update(scene);
+    failures += (layout.ButtonCount() != 5 || layout.Button(4).action != UiAction::StartGame);
+    checkHits();
+    
+    // Cells take clicks up to the grid lines during a game, and none once it is over
+    scene.screen = GameScreen::Game;
+    failures += !layout.Update(scene);
+    checkHits();
+    const Widget* corner = layout.HitTest(UiLayout::BOARD_LEFT, UiLayout::BOARD_TOP);
+    failures += (!corner || corner->kind != WidgetKind::Cell || corner->row != 0 || corner->col != 0);
+    const Widget* middle = layout.HitTest(UiLayout::BOARD_LEFT + UiLayout::CELL_SIZE * 2 - 1,
+                                          UiLayout::BOARD_TOP + UiLayout::CELL_SIZE);
+    failures += (!middle || middle->row != 1 || middle->col != 1);
+    failures += (layout.HitTest(UiLayout::BOARD_LEFT - 1, UiLayout::BOARD_TOP) != nullptr);
+    
+    for (int cell : {0, 3, 1, 4, 2}) {
+        game.Play(cell / 3, cell % 3);
+    }
+    scene.screen = GameScreen::GameOver;
+    failures += !layout.Update(scene);
+    failures += (layout.ButtonCount() != 2);
+    checkHits();
+    failures += (layout.HitTest(UiLayout::BOARD_LEFT + 10, UiLayout::BOARD_TOP + 10) != nullptr);
+    
+    return failures;
+}
+
+// The scene model must mark just the cells, buttons and status line that changed, and
+// repainting only those areas must give the same frame as repainting the whole window.
+// Returns the number of failures.
+static int VerifyDirtyRegions() {
+    int failures = 0;
+    PixelRenderer partial;
+    PixelRenderer full;
+    partial.Resize(UiLayout::WINDOW_WIDTH, UiLayout::WINDOW_HEIGHT);
+    full.Resize(UiLayout::WINDOW_WIDTH, UiLayout::WINDOW_HEIGHT);
+    UiLayout layout;
+    SceneModel model;
+    
+    // Moves to scene, checks the region against expected and the partial frame against a full one
+    auto step = [&](const SceneState& scene, std::initializer_list<Rect> expected) {
+        DirtyRegion region;
+        layout.Update(scene);
+        model.Update(scene, layout, region);
+        failures += (region.Count() != (int)expected.size());
+        for (const Rect& rect : expected) {
+            failures += std::none_of(region.begin(), region.end(), [&](const Rect& dirty) { return dirty == rect; });
+        }
+        for (const Rect& rect : region) {
+            ScenePainter::Paint(partial, scene, layout, rect);
+        }
+        ScenePainter::Paint(full, scene, layout);
+        failures += (partial.Checksum() != full.Checksum());
+    };
+    
+    GameCore game;
+    game.Start(PlayerType::Human, PlayerType::AI);
+    SceneState scene;
+    scene.game = &game;
+    scene.statusText = L"Player X's turn (Human)";
+    const Rect window = UiLayout::WindowRect();
+    
+    // First frame, then picking a difficulty repaints the old and new buttons
+    step(scene, {window});
+    scene.difficulty = AIDifficulty::Hard;
+    step(scene, {layout.Button(5).rect, layout.Button(6).rect});
+    scene.hoveredButton = 7;
+    step(scene, {layout.Button(7).rect});
+    
+    // Hiding the difficulty row moves the layout
+    scene.hoveredButton = -1;
+    scene.oPlayerType = PlayerType::Human;
+    step(scene, {window});
+    
+    // Hover moving between cells repaints both, and nothing else
+    scene.screen = GameScreen::Game;
+    step(scene, {window});
+    scene.hoverRow = 0;
+    scene.hoverCol = 0;
+    step(scene, {UiLayout::CellRect(0, 0)});
+    scene.hoverRow = 1;
+    scene.hoverCol = 2;
+    step(scene, {UiLayout::CellRect(0, 0), UiLayout::CellRect(1, 2)});
+    step(scene, {});
+    scene.hoveredButton = 0;
+    step(scene, {layout.Button(0).rect});
+    scene.hoveredButton = -1;
+    step(scene, {layout.Button(0).rect});
+    
+    // A move repaints its cell and the status line
+    scene.hoverRow = -1;
+    scene.hoverCol = -1;
+    game.Play(1, 2);
+    scene.statusText = L"Player O's turn (Human)";
+    step(scene, {UiLayout::CellRect(1, 2), UiLayout::StatusRect()});
+    
+    // The winning move ends the game under a full-window overlay
+    game.Play(0, 0);
+    game.Play(1, 1);
+    game.Play(0, 1);
+    step(scene, {UiLayout::CellRect(0, 0), UiLayout::CellRect(1, 1), UiLayout::CellRect(0, 1)});
+    game.Play(1, 0);
+    scene.screen = GameScreen::GameOver;
+    step(scene, {window});
+    scene.hoveredButton = 1;
+    step(scene, {layout.Button(1).rect});
+    
+    // The region merges overlaps and stays within its capacity
+    DirtyRegion region;
+    region.Add({0, 0, 10, 10});
+    region.Add({5, 5, 20, 20});
+    region.Add({2, 2, 8, 8});
+    failures += (region.Count() != 1 || region[0] != Rect{0, 0, 20, 20});
+    for (int i = 0; i < 20; i++) {
+        region.Add({100 + i * 20, 0, 110 + i * 20, 10});
+    }
+    failures += (region.Count() > DirtyRegion::MAX_RECTS);
+    
+    return failures;
+}
+
+// Histogram buckets must bound their samples within 25%, the window must roll, and
+// recording must neither allocate nor lose the trace. Returns the number of failures.
+static int VerifyFrameStats() {
+    int failures = 0;
+    
+    // Every value lands in a bucket whose limit is at least it and within a quarter of it
+    for (uint64_t value = 0; value <= UINT32_MAX; value = value * 5 / 4 + 1) {
+        uint32_t limit = RollingHistogram::BucketLimit(RollingHistogram::BucketOf((uint32_t)value));
+        failures += (limit < value || limit - value > value / 4);
+    }
+    failures += (RollingHistogram::BucketOf(UINT32_MAX) >= RollingHistogram::BUCKETS);
+    
+    // Percentiles of 1..100 and the window dropping the oldest samples
+    RollingHistogram histogram;
+    failures += (histogram.Percentile(0.5) != 0 || histogram.Max() != 0);
+    for (uint32_t i = 1; i <= 100; i++) {
+        histogram.Add(i);
+    }
+    failures += (histogram.Count() != 100 || histogram.Max() != 100 || histogram.Mean() != 50.5);
+    failures += (histogram.Percentile(0.5) < 50 || histogram.Percentile(0.5) > 62);
+    failures += (histogram.Percentile(1.0) < 100 || histogram.Percentile(1.0) > 125);
+    for (int i = 0; i < RollingHistogram::WINDOW; i++) {
+        histogram.Add(7);
+    }
+    failures += (histogram.Count() != RollingHistogram::WINDOW || histogram.Max() != 7);
+    failures += (histogram.Percentile(0.99) != 7 || histogram.Mean() != 7.0);
+    
+    // Latency pairs the first input with the next frame, and a cancelled input is dropped
+    FrameStats stats(8);
+    auto at = [](int micros) { return FrameStats::Clock::time_point(std::chrono::microseconds(micros)); };
+    stats.InputArrived(at(100));
+    stats.InputArrived(at(150));
+    stats.FramePresented(at(400));
+    stats.FramePresented(at(900));
+    stats.InputArrived(at(1000));
+    stats.CancelInput();
+    stats.FramePresented(at(1200));
+    const RollingHistogram& latency = stats.Histogram(FramePhase::Latency);
+    failures += (latency.Count() != 1 || latency.Max() != 300);
+    
+    // Recording allocates nothing, and the trace keeps only the newest events
+    uint64_t before = AllocationCount();
+    for (int i = 0; i < 20; i++) {
+        FrameStats::Scope timer(stats, FramePhase::Draw);
+    }
+    failures += (AllocationCount() != before);
+    failures += (stats.Histogram(FramePhase::Draw).Count() != 20 || stats.TraceEventCount() != 8);
+    
+    // The trace holds one complete event per traced phase
+    const char* path = "selfcheck_trace.tmp";
+    failures += !stats.WriteTrace(path);
+    std::FILE* file = std::fopen(path, "r");
+    std::string json;
+    if (file) {
+        char buffer[4096];
+        size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            json.append(buffer, read);
+        }
+        std::fclose(file);
+    }
+    std::remove(path);
+    int events = 0;
+    for (size_t at = json.find("\"ph\": \"X\""); at != std::string::npos; at = json.find("\"ph\": \"X\"", at + 1)) {
+        events++;
+    }
+    failures += (events != 8 || json.find("\"name\": \"draw\"") == std::string::npos);
+    failures += (json.rfind("{\"displayTimeUnit\"", 0) != 0 || json.size() < 4 ||
+                 json.compare(json.size() - 4, 4, "\n]}\n") != 0);
+    
+    return failures;
+}
+
+// Counts search trace events by kind
+class CountingTraceSink : public SearchTraceSink {
+public:
+    void Trace(const SearchTraceEvent& event) override { counts[(int)event.kind]++; }
+    
+    std::array<uint64_t, 6> counts = {};
+};
+
+// LastSearchStats must say where each move came from, and its counters and root moves
+// must add up to the nodes searched. Trace events must match the counters in
+// XO_SEARCH_TRACE builds and never arrive otherwise. Returns the number of failures.
+static int VerifySearchStats() {
+    int failures = 0;
+    AIPlayer ai;
+    CountingTraceSink sink;
+    ai.SetTraceSink(&sink);
+    const SearchStats& stats = ai.LastSearchStats();
+    
+    // Easy and the 3x3 Hard table search nothing
+    ai.GetBestMove(Bitboard{}, Mark::X, AIPlayer::Difficulty::Easy);
+    failures += (stats.source != SearchStats::Source::Random || stats.nodes != 0);
+    ai.GetBestMove(Bitboard{}, Mark::X, AIPlayer::Difficulty::Hard);
+    failures += (stats.source != SearchStats::Source::PerfectPlay || stats.nodes != 0 || stats.rootMoveCount != 0);
+    
+    // A cold Minimax search lists every root move with its exact score; their nodes and
+    // times add up to the whole search
+    ai.ClearSearchCache();
+    ai.SetSearchTiming(true);
+    uint64_t before = ai.NodesSearched();
+    int score;
+    std::pair<int, int> move = ai.GetSearchedMove(Bitboard{}, Mark::X, &score);
+    failures += (stats.source != SearchStats::Source::Search || stats.nodes != ai.NodesSearched() - before);
+    failures += (stats.rootMoveCount != 9 || stats.maxDepth != 9 || stats.cutoffs == 0);
+    failures += (stats.leafEvaluations == 0 || stats.tableHits == 0 || stats.tableHits > stats.tableProbes);
+    uint64_t rootNodes = 0;
+    double rootSeconds = 0.0;
+    for (int i = 0; i < stats.rootMoveCount; i++) {
+        const RootMoveStats& root = stats.rootMoves[i];
+        rootNodes += root.nodes;
+        rootSeconds += root.seconds;
+        failures += (root.score > score || root.seconds < 0.0);
+        failures += (root.cell == move.first * 3 + move.second && root.score != score);
+    }
+    failures += (rootNodes != stats.nodes || stats.seconds <= 0.0 || std::abs(rootSeconds - stats.seconds) > 1e-9);
+    
+    uint64_t traced = sink.counts[(int)SearchTraceKind::Node] + sink.counts[(int)SearchTraceKind::RootMove];
+    if (SEARCH_TRACE_ENABLED) {
+        failures += (sink.counts[(int)SearchTraceKind::Node] != stats.nodes);
+        failures += (sink.counts[(int)SearchTraceKind::Cutoff] != stats.cutoffs);
+        failures += (sink.counts[(int)SearchTraceKind::RootMove] != 9);
+    } else {
+        failures += (traced != 0);
+    }
+    
+    // The larger-board search at a fixed depth, on one thread and then two: the move
+    // played has the best root score, and the others are bounds no higher
+    ai.SetSearchDepth(3);
+    for (int threads = 1; threads <= 2; threads++) {
+        ai.SetThreadCount(threads);
+        ai.NewGame();
+        sink.counts = {};
+        before = ai.NodesSearched();
+        move = ai.GetBestMove(GridBoard<4, 3>(), Mark::X, AIPlayer::Difficulty::Hard);
+        failures += (stats.source != SearchStats::Source::Search || stats.nodes != ai.NodesSearched() - before);
+        failures += (stats.rootMoveCount != 16 || stats.maxDepth != 3 || stats.leafEvaluations == 0);
+        failures += (stats.tableProbes == 0 || stats.seconds <= 0.0);
+        const RootMoveStats* played = nullptr;
+        int bestRoot = -WIN_SCORE - 1;
+        for (int i = 0; i < stats.rootMoveCount; i++) {
+            const RootMoveStats& root = stats.rootMoves[i];
+            bestRoot = std::max(bestRoot, root.score);
+            if (root.cell == move.first * 4 + move.second) {
+                played = &root;
+            }
+        }
+        failures += (!played || played->score != bestRoot || played->nodes == 0);
+        if (SEARCH_TRACE_ENABLED && threads == 1) {
+            failures += (sink.counts[(int)SearchTraceKind::Node] != stats.nodes);
+            failures += (sink.counts[(int)SearchTraceKind::Iteration] != 3);
+        }
+    }
+    
+    // MonteCarlo reports its playouts
+    ai.SetPlayoutBudget(500);
+    ai.GetBestMove(Bitboard{}, Mark::X, AIPlayer::Difficulty::MonteCarlo);
+    failures += (stats.source != SearchStats::Source::MonteCarlo || stats.nodes != ai.LastMctsResult().playouts);
+    
+    return failures;
+}
+
+static bool Report(const char* name, int mismatches) {
+    if (mismatches != 0) {
+        std::printf("%s FAILED: %d mismatches\n", name, mismatches);
+        return false;
+    }
+    
+    std::printf("%s passed\n", name);
+    return true;
+}
+
+// Verifies the compiled-in perfect-play table against the runtime searches
+int main() {
+    AIPlayer ai;
+    bool ok = Report("Perfect-play table vs Minimax", ai.VerifyPerfectPlayTable());
+    ok = Report("Generic engine on Bitboard", VerifyGenericEngine<BoardFor<3, 3>>()) && ok;
+    ok = Report("Generic engine on GridBoard<3, 3>", VerifyGenericEngine<GridBoard<3, 3>>()) && ok;
+    ok = Report("Generic engine with 4 threads", VerifyGenericEngine<GridBoard<3, 3>>(4)) && ok;
+    ok = Report("Async search and cancellation", VerifyAsyncSearch()) && ok;
+    ok = Report("Game core rules", VerifyGameCore()) && ok;
+    ok = Report("Allocation-free GetBestMove", VerifyAllocationFree()) && ok;
+    ok = Report("Batch evaluation on 4 threads", VerifyBatchEvaluation()) && ok;
+    ok = Report("MonteCarlo difficulty", VerifyMonteCarlo()) && ok;
+    ok = Report("Search statistics and tracing", VerifySearchStats()) && ok;
+    ok = Report("Arena allocator", VerifyArena()) && ok;
+    ok = Report("Opening book", VerifyOpeningBook()) && ok;
+    ok = Report("Game records", VerifyGameRecords()) && ok;
+    ok = Report("Move-list logs", VerifyMoveLists()) && ok;
+    ok = Report("Frame rendering", VerifyFrameRendering()) && ok;
+    ok = Report("Widget layout and hit-testing", VerifyWidgetLayout()) && ok;
+    ok = Report("Dirty regions", VerifyDirtyRegions()) && ok;
+    ok = Report("Frame statistics and traces", VerifyFrameStats()) && ok;
+    ok = Report((std::string("Board status batch (") + BoardStatusKernel() + ")").c_str(), VerifyBoardStatusBatch()) && ok;
+    
+    return ok ? 0 : 1;
+}
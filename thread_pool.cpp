@@ -0,0 +1,84 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+// Chunks per thread in a loop: small enough to balance, large enough to amortize the handout
+static constexpr size_t CHUNKS_PER_THREAD = 8;
+
+ThreadPool::ThreadPool(int threads) {
+    for (int i = 1; i < threads; i++) {
+        m_workers.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const Body& body) {
+    if (count == 0) {
+        return;
+    }
+    if (m_workers.empty()) {
+        body(0, count);
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_count = count;
+        m_chunk = std::max<size_t>(1, count / (Size() * CHUNKS_PER_THREAD));
+        m_next = 0;
+        m_busy = (int)m_workers.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+    
+    RunChunks();
+    
+    // Workers still finishing their last chunk hold a pointer to body
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+    m_body = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+    uint64_t seen = 0;
+    
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, seen]() { return m_stop || m_generation != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_generation;
+        }
+        
+        RunChunks();
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy--;
+        }
+        m_done.notify_one();
+    }
+}
+
+void ThreadPool::RunChunks() {
+    while (true) {
+        size_t begin = m_next.fetch_add(m_chunk);
+        if (begin >= m_count) {
+            return;
+        }
+        (*m_body)(begin, std::min(begin + m_chunk, m_count));
+    }
+}
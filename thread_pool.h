@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. The calling thread works
+// alongside the pool, so a pool of size 1 has no workers and runs loops inline.
+class ThreadPool {
+public:
+    using Body = std::function<void(size_t begin, size_t end)>;
+    
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    // Threads taking part in a loop, the caller included
+    int Size() const { return (int)m_workers.size() + 1; }
+    
+    // Calls body on consecutive chunks covering [0, count) and returns once all have run.
+    // Chunks are handed out on demand, so uneven items balance across threads.
+    // Not reentrant: call from one thread at a time, and not from inside body.
+    void ParallelFor(size_t count, const Body& body);
+
+private:
+    void WorkerLoop();
+    void RunChunks();
+    
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    
+    // The loop in progress, published under m_mutex
+    const Body* m_body = nullptr;
+    size_t m_count = 0;
+    size_t m_chunk = 1;
+    std::atomic<size_t> m_next{0};
+    uint64_t m_generation = 0;
+    int m_busy = 0;
+    bool m_stop = false;
+};
@@ -0,0 +1,48 @@
+#include "transposition_table.h"
+#include <algorithm>
+
+// Layout of a slot's data word
+static uint64_t PackEntry(int score, int move, int depth, Bound bound) {
+    return uint64_t(uint16_t(score)) | 
+           (uint64_t(uint16_t(move)) << 16) | 
+           (uint64_t(depth) << 32) | 
+           (uint64_t(bound) << 40);
+}
+
+TranspositionTable::TranspositionTable(int sizeLog2) 
+    : m_slots(new Slot[size_t(1) << sizeLog2]), 
+      m_size(size_t(1) << sizeLog2), 
+      m_mask((uint64_t(1) << sizeLog2) - 1) {
+}
+
+bool TranspositionTable::Probe(uint64_t key, TTEntry& entry) const {
+    const Slot& slot = m_slots[key & m_mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    
+    Bound bound = Bound((data >> 40) & 0xFF);
+    if (bound == Bound::None || (check ^ data) != key) {
+        return false;
+    }
+    
+    entry.key = key;
+    entry.score = int16_t(data & 0xFFFF);
+    entry.move = int16_t((data >> 16) & 0xFFFF);
+    entry.depth = uint8_t((data >> 32) & 0xFF);
+    entry.bound = bound;
+    return true;
+}
+
+void TranspositionTable::Store(uint64_t key, int score, Bound bound, int depth, int move) {
+    Slot& slot = m_slots[key & m_mask];
+    uint64_t data = PackEntry(score, move, std::min(depth, 255), bound);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::Clear() {
+    for (size_t i = 0; i < m_size; i++) {
+        m_slots[i].data.store(0, std::memory_order_relaxed);
+        m_slots[i].check.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+// How a stored score relates to the true minimax value of the position
+enum class Bound : uint8_t { None, Exact, Lower, Upper };
+
+struct TTEntry {
+    uint64_t key = 0;
+    int16_t score = 0;
+    int16_t move = -1;      // Best cell found, tried first when the position is searched again
+    uint8_t depth = 0;      // Remaining depth the score was searched to
+    Bound bound = Bound::None;
+};
+
+// Direct-mapped table of searched positions; a slot keeps the most recent store.
+// Safe to share between search threads without locks: each slot holds the packed
+// entry and the key XORed with it, so a slot torn by concurrent writers fails the
+// key check on probe instead of returning a mix of two entries.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(int sizeLog2 = 16);
+    
+    // Returns true and fills entry if the key is present
+    bool Probe(uint64_t key, TTEntry& entry) const;
+    void Store(uint64_t key, int score, Bound bound, int depth = 0, int move = -1);
+    void Clear();
+    
+    size_t Size() const { return m_size; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{0};     // key ^ data
+        std::atomic<uint64_t> data{0};      // score, move, depth and bound packed
+    };
+    
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_size;
+    uint64_t m_mask;
+};
@@ -0,0 +1,315 @@
+#include "ui_layout.h"
+#include <algorithm>
+
+bool UiLayout::Update(const SceneState& scene) {
+    bool difficulty = ShowsDifficulty(scene);
+    GameResult result = scene.game ? scene.game->Result() : GameResult::Playing;
+    if (m_generation != 0 && scene.screen == m_screen && difficulty == m_difficulty && result == m_result) {
+        return false;
+    }
+
+    m_screen = scene.screen;
+    m_difficulty = difficulty;
+    m_result = result;
+    Build(scene);
+    return true;
+}
+
+void UiLayout::Build(const SceneState& scene) {
+    m_count = 0;
+    m_buttonCount = 0;
+    for (Bucket& bucket : m_buckets) {
+        bucket.count = 0;
+    }
+
+    switch (scene.screen) {
+        case GameScreen::Welcome:
+            BuildWelcome(scene);
+            break;
+        case GameScreen::Game:
+            BuildGame();
+            break;
+        case GameScreen::GameOver:
+            BuildGameOver(m_result);
+            break;
+    }
+    m_generation++;
+}
+
+void UiLayout::BuildWelcome(const SceneState& scene) {
+    // Calculate left margin for buttons and labels aligned with the board
+    int leftMargin = (WINDOW_WIDTH - 400) / 2; // Center the content in a 400px wide area
+
+    // Title shadow first (slight offset), then the title - positioned higher
+    AddLabel({2, 62, WINDOW_WIDTH, 112}, L"XO Game", FontId::Title, TextAlign::Center, true);
+    AddLabel({0, 60, WINDOW_WIDTH, 110}, L"XO Game", FontId::Title, TextAlign::Center);
+
+    // Player X section positioned lower
+    AddLabel({leftMargin, 140, WINDOW_WIDTH - leftMargin, 170}, L"Player X:", FontId::Status, TextAlign::Left);
+
+    // Player X options (Human or AI)
+    Rect humanXButtonRect = {
+        leftMargin + BUTTON_PADDING,
+        170,
+        leftMargin + BUTTON_PADDING + BUTTON_WIDTH,
+        170 + BUTTON_HEIGHT
+    };
+    AddButton(humanXButtonRect, L"Human", UiAction::XHuman);
+
+    Rect aiXButtonRect = {
+        leftMargin + BUTTON_PADDING + BUTTON_WIDTH + BUTTON_PADDING,
+        170,
+        leftMargin + BUTTON_PADDING + BUTTON_WIDTH * 2 + BUTTON_PADDING,
+        170 + BUTTON_HEIGHT
+    };
+    AddButton(aiXButtonRect, L"AI", UiAction::XAI);
+
+    // Player O options - moved down more
+    AddLabel({leftMargin, 230, WINDOW_WIDTH - leftMargin, 260}, L"Player O:", FontId::Status, TextAlign::Left);
+
+    Rect humanOButtonRect = {
+        leftMargin + BUTTON_PADDING,
+        260,
+        leftMargin + BUTTON_PADDING + BUTTON_WIDTH,
+        260 + BUTTON_HEIGHT
+    };
+    AddButton(humanOButtonRect, L"Human", UiAction::OHuman);
+
+    Rect aiOButtonRect = {
+        leftMargin + BUTTON_PADDING + BUTTON_WIDTH + BUTTON_PADDING,
+        260,
+        leftMargin + BUTTON_PADDING + BUTTON_WIDTH * 2 + BUTTON_PADDING,
+        260 + BUTTON_HEIGHT
+    };
+    AddButton(aiOButtonRect, L"AI", UiAction::OAI);
+
+    // Show AI difficulty options if either player is AI
+    if (ShowsDifficulty(scene)) {
+        AddLabel({leftMargin, 320, WINDOW_WIDTH - leftMargin, 350}, L"AI Difficulty:", FontId::Status,
+                 TextAlign::Left);
+
+        // Three difficulty buttons side by side
+        int buttonWidth = BUTTON_WIDTH / 2;
+        int totalWidth = buttonWidth * 3 + BUTTON_PADDING * 2;
+        int startX = WINDOW_WIDTH / 2 - totalWidth / 2;
+
+        const wchar_t* labels[] = {L"Easy", L"Normal", L"Hard"};
+        const UiAction actions[] = {UiAction::Easy, UiAction::Normal, UiAction::Hard};
+        for (int i = 0; i < 3; i++) {
+            Rect rect = {
+                startX + (buttonWidth + BUTTON_PADDING) * i,
+                350,
+                startX + (buttonWidth + BUTTON_PADDING) * i + buttonWidth,
+                350 + BUTTON_HEIGHT
+            };
+            AddButton(rect, labels[i], actions[i]);
+        }
+    }
+
+    // Start game button - centered and positioned lower
+    Rect startButtonRect = {
+        WINDOW_WIDTH / 2 - BUTTON_WIDTH / 2,
+        420,
+        WINDOW_WIDTH / 2 + BUTTON_WIDTH / 2,
+        420 + BUTTON_HEIGHT
+    };
+    AddButton(startButtonRect, L"Start Game", UiAction::StartGame);
+
+    // Instructions - moved to bottom
+    AddLabel({0, 500, WINDOW_WIDTH, 530}, L"Press ESC to exit", FontId::Status, TextAlign::Center);
+}
+
+void UiLayout::BuildGame() {
+    // The game board, then the status text in a better position
+    AddBoard(true);
+    Add(WidgetKind::Status, StatusRect());
+
+    // Menu button - centered horizontally
+    Rect menuButtonRect = {
+        WINDOW_WIDTH / 2 - BUTTON_WIDTH / 2,
+        BOARD_TOP + GRID_SIZE * CELL_SIZE + 70,
+        WINDOW_WIDTH / 2 + BUTTON_WIDTH / 2,
+        BOARD_TOP + GRID_SIZE * CELL_SIZE + 70 + BUTTON_HEIGHT
+    };
+    AddButton(menuButtonRect, L"Menu", UiAction::Menu);
+}
+
+void UiLayout::BuildGameOver(GameResult result) {
+    // The game board (shows final state) under a semi-transparent overlay
+    AddBoard(false);
+    Add(WidgetKind::Overlay, WindowRect());
+
+    // Title at the top-center of the board area
+    const wchar_t* gameOverText;
+    if (result == GameResult::XWon) {
+        gameOverText = L"Player X Wins!";
+    } else if (result == GameResult::OWon) {
+        gameOverText = L"Player O Wins!";
+    } else {
+        gameOverText = L"Game Draw!";
+    }
+    AddLabel({0, BOARD_TOP - 10, WINDOW_WIDTH, BOARD_TOP + 60}, gameOverText, FontId::Title, TextAlign::Center);
+
+    // Buttons at the bottom of the game area
+    int buttonY = BOARD_TOP + GRID_SIZE * CELL_SIZE + 20;
+
+    // Play again button - on the left side
+    Rect playAgainButtonRect = {
+        WINDOW_WIDTH / 2 - BUTTON_WIDTH - 10,
+        buttonY,
+        WINDOW_WIDTH / 2 - 10,
+        buttonY + BUTTON_HEIGHT
+    };
+    AddButton(playAgainButtonRect, L"Play Again", UiAction::PlayAgain);
+
+    // Menu button - on the right side
+    Rect menuButtonRect = {
+        WINDOW_WIDTH / 2 + 10,
+        buttonY,
+        WINDOW_WIDTH / 2 + BUTTON_WIDTH + 10,
+        buttonY + BUTTON_HEIGHT
+    };
+    AddButton(menuButtonRect, L"Main Menu", UiAction::Menu);
+}
+
+Widget& UiLayout::Add(WidgetKind kind, const Rect& rect) {
+    Widget& widget = m_widgets[m_count++];
+    widget = Widget();
+    widget.kind = kind;
+    widget.rect = rect;
+    return widget;
+}
+
+void UiLayout::AddLabel(const Rect& rect, const wchar_t* text, FontId font, TextAlign align, bool shadow) {
+    Widget& widget = Add(WidgetKind::Label, rect);
+    widget.text = text;
+    widget.font = font;
+    widget.align = align;
+    widget.shadow = shadow;
+}
+
+void UiLayout::AddButton(const Rect& rect, const wchar_t* text, UiAction action) {
+    Widget& widget = Add(WidgetKind::Button, rect);
+    widget.text = text;
+    widget.font = FontId::Button;
+    widget.action = action;
+    widget.button = m_buttonCount;
+
+    // Edges included, as the window has always hit-tested its buttons
+    widget.hitRect = {rect.left, rect.top, rect.right + 1, rect.bottom + 1};
+    m_buttons[m_buttonCount++] = (uint8_t)(m_count - 1);
+    Index();
+}
+
+void UiLayout::AddBoard(bool clickable) {
+    // The frame's pen reaches a couple of pixels outside the 5 pixel margin
+    Add(WidgetKind::Board, {BOARD_LEFT - 7, BOARD_TOP - 7, BOARD_LEFT + GRID_SIZE * CELL_SIZE + 7,
+                            BOARD_TOP + GRID_SIZE * CELL_SIZE + 7});
+
+    for (int row = 0; row < GRID_SIZE; row++) {
+        for (int col = 0; col < GRID_SIZE; col++) {
+            Widget& cell = Add(WidgetKind::Cell, CellRect(row, col));
+            cell.row = row;
+            cell.col = col;
+
+            // Clicks take the whole cell, grid lines included
+            if (clickable) {
+                cell.hitRect = {
+                    BOARD_LEFT + col * CELL_SIZE,
+                    BOARD_TOP + row * CELL_SIZE,
+                    BOARD_LEFT + (col + 1) * CELL_SIZE,
+                    BOARD_TOP + (row + 1) * CELL_SIZE
+                };
+                Index();
+            }
+        }
+    }
+}
+
+void UiLayout::Index() {
+    const Rect& hit = m_widgets[m_count - 1].hitRect;
+    int firstColumn = std::max(hit.left, 0) / BUCKET_SIZE;
+    int lastColumn = std::min(hit.right - 1, WINDOW_WIDTH - 1) / BUCKET_SIZE;
+    int firstRow = std::max(hit.top, 0) / BUCKET_SIZE;
+    int lastRow = std::min(hit.bottom - 1, WINDOW_HEIGHT - 1) / BUCKET_SIZE;
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            Bucket& bucket = m_buckets[row * BUCKET_COLUMNS + column];
+            if (bucket.count < BUCKET_CAPACITY) {
+                bucket.widgets[bucket.count++] = (uint8_t)(m_count - 1);
+            } else {
+                bucket.count = BUCKET_OVERFLOW;
+            }
+        }
+    }
+}
+
+const Widget* UiLayout::HitTest(int x, int y) const {
+    if (x < 0 || x >= WINDOW_WIDTH || y < 0 || y >= WINDOW_HEIGHT) {
+        return nullptr;
+    }
+
+    auto hits = [x, y](const Widget& widget) {
+        const Rect& hit = widget.hitRect;
+        return x >= hit.left && x < hit.right && y >= hit.top && y < hit.bottom;
+    };
+
+    // Hit areas do not overlap, but the first widget wins if they ever do
+    const Bucket& bucket = m_buckets[(y / BUCKET_SIZE) * BUCKET_COLUMNS + x / BUCKET_SIZE];
+    if (bucket.count == BUCKET_OVERFLOW) {
+        for (const Widget& widget : *this) {
+            if (hits(widget)) {
+                return &widget;
+            }
+        }
+        return nullptr;
+    }
+    const Widget* found = nullptr;
+    for (int i = 0; i < bucket.count; i++) {
+        const Widget& widget = m_widgets[bucket.widgets[i]];
+        if (hits(widget) && (!found || &widget < found)) {
+            found = &widget;
+        }
+    }
+    return found;
+}
+
+Rect UiLayout::CellRect(int row, int col) {
+    // Inside the grid lines
+    return {
+        BOARD_LEFT + col * CELL_SIZE + 1,
+        BOARD_TOP + row * CELL_SIZE + 1,
+        BOARD_LEFT + (col + 1) * CELL_SIZE - 1,
+        BOARD_TOP + (row + 1) * CELL_SIZE - 1
+    };
+}
+
+Rect UiLayout::StatusRect() {
+    return {
+        0,
+        BOARD_TOP + GRID_SIZE * CELL_SIZE + 20,
+        WINDOW_WIDTH,
+        BOARD_TOP + GRID_SIZE * CELL_SIZE + 50
+    };
+}
+
+bool UiLayout::IsActive(const SceneState& scene, UiAction action) {
+    switch (action) {
+        case UiAction::XHuman:
+            return scene.xPlayerType == PlayerType::Human;
+        case UiAction::XAI:
+            return scene.xPlayerType == PlayerType::AI;
+        case UiAction::OHuman:
+            return scene.oPlayerType == PlayerType::Human;
+        case UiAction::OAI:
+            return scene.oPlayerType == PlayerType::AI;
+        case UiAction::Easy:
+            return scene.difficulty == AIDifficulty::Easy;
+        case UiAction::Normal:
+            return scene.difficulty == AIDifficulty::Normal;
+        case UiAction::Hard:
+            return scene.difficulty == AIDifficulty::Hard;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "game_core.h"
+#include "render.h"
+
+enum class GameScreen { Welcome, Game, GameOver };
+enum class AIDifficulty { Easy, Normal, Hard };
+
+// What a button does when clicked
+enum class UiAction { None, XHuman, XAI, OHuman, OAI, Easy, Normal, Hard, StartGame, PlayAgain, Menu };
+
+// Everything a frame shows
+struct SceneState {
+    GameScreen screen = GameScreen::Welcome;
+    PlayerType xPlayerType = PlayerType::Human;
+    PlayerType oPlayerType = PlayerType::AI;
+    AIDifficulty difficulty = AIDifficulty::Normal;
+    int hoveredButton = -1;     // Widget::button of the hovered button
+    int hoverRow = -1;
+    int hoverCol = -1;
+    const GameCore* game = nullptr;
+    const wchar_t* statusText = L"";
+};
+
+enum class WidgetKind { Label, Button, Board, Cell, Status, Overlay };
+
+// One element of a screen. Widgets are drawn in order; buttons and board cells also
+// take the mouse.
+struct Widget {
+    WidgetKind kind = WidgetKind::Label;
+    Rect rect = {0, 0, 0, 0};       // Area drawn
+    Rect hitRect = {0, 0, 0, 0};    // Area under the mouse, right and bottom exclusive; empty if none
+    const wchar_t* text = L"";      // Labels and buttons
+    FontId font = FontId::Status;
+    TextAlign align = TextAlign::Center;
+    bool shadow = false;            // Labels drawn in the shadow colour
+    UiAction action = UiAction::None;
+    int button = -1;                // Buttons: number on the screen, in drawing order
+    int row = -1;                   // Cells
+    int col = -1;
+};
+
+// Widgets of the current screen, laid out once when the screen or its layout changes
+// rather than on every paint, with a grid of buckets over the window so a mouse
+// position is hit-tested against the one or two widgets near it. Painting, hover and
+// clicks all read the same layout; nothing in it allocates.
+class UiLayout {
+public:
+    static constexpr int GRID_SIZE = GameCore::GRID_SIZE;
+    static constexpr int CELL_SIZE = 120;    // Increased from 100
+    static constexpr int WINDOW_WIDTH = 500;  // Fixed window width
+    static constexpr int WINDOW_HEIGHT = 600; // Fixed window height
+    static constexpr int BUTTON_HEIGHT = 45;  // Increased from 40
+    static constexpr int BUTTON_WIDTH = 180;  // Increased from 150
+    static constexpr int BUTTON_PADDING = 15; // Increased from 10
+
+    // Board centred horizontally and placed a little above the middle
+    static constexpr int BOARD_LEFT = (WINDOW_WIDTH - GRID_SIZE * CELL_SIZE) / 2;
+    static constexpr int BOARD_TOP = (WINDOW_HEIGHT - GRID_SIZE * CELL_SIZE) / 2 - 60;
+
+    static constexpr int MAX_WIDGETS = 32;
+
+    // Lays out scene's screen unless the current layout already fits it; returns whether
+    // it was rebuilt. Only the screen, whether the difficulty row shows and the game's
+    // result change the layout.
+    bool Update(const SceneState& scene);
+
+    // Counts layouts built, so a caller can tell the widgets have moved
+    uint32_t Generation() const { return m_generation; }
+
+    int Count() const { return m_count; }
+    const Widget& operator[](int index) const { return m_widgets[index]; }
+    const Widget* begin() const { return m_widgets.data(); }
+    const Widget* end() const { return m_widgets.data() + m_count; }
+
+    int ButtonCount() const { return m_buttonCount; }
+    const Widget& Button(int number) const { return m_widgets[m_buttons[number]]; }
+
+    // Widget under a window point, or nullptr
+    const Widget* HitTest(int x, int y) const;
+
+    // Areas the painter fills, for working out what a change needs redrawn
+    static Rect WindowRect() { return {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT}; }
+    static Rect CellRect(int row, int col);
+    static Rect StatusRect();
+
+    // Whether the button for action shows as selected
+    static bool IsActive(const SceneState& scene, UiAction action);
+
+    // Whether the welcome screen shows the difficulty buttons, which moves its layout
+    static bool ShowsDifficulty(const SceneState& scene) {
+        return scene.xPlayerType == PlayerType::AI || scene.oPlayerType == PlayerType::AI;
+    }
+
+private:
+    // Buckets of BUCKET_SIZE pixels square; one that fills up is marked overflowing and
+    // searched through every widget instead
+    static constexpr int BUCKET_SIZE = 50;
+    static constexpr int BUCKET_COLUMNS = (WINDOW_WIDTH + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    static constexpr int BUCKET_ROWS = (WINDOW_HEIGHT + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    static constexpr int BUCKET_CAPACITY = 6;
+    static constexpr uint8_t BUCKET_OVERFLOW = 0xFF;
+
+    struct Bucket {
+        uint8_t count;
+        std::array<uint8_t, BUCKET_CAPACITY> widgets;
+    };
+
+    void Build(const SceneState& scene);
+    void BuildWelcome(const SceneState& scene);
+    void BuildGame();
+    void BuildGameOver(GameResult result);
+
+    Widget& Add(WidgetKind kind, const Rect& rect);
+    void AddLabel(const Rect& rect, const wchar_t* text, FontId font, TextAlign align, bool shadow = false);
+    void AddButton(const Rect& rect, const wchar_t* text, UiAction action);
+    void AddBoard(bool clickable);
+
+    // Adds the last widget to the buckets its hit area touches
+    void Index();
+
+    std::array<Widget, MAX_WIDGETS> m_widgets;
+    int m_count = 0;
+    std::array<uint8_t, MAX_WIDGETS> m_buttons;     // Widget index of each button
+    int m_buttonCount = 0;
+    std::array<Bucket, BUCKET_COLUMNS * BUCKET_ROWS> m_buckets = {};
+
+    uint32_t m_generation = 0;
+    GameScreen m_screen = GameScreen::Welcome;
+    bool m_difficulty = false;
+    GameResult m_result = GameResult::Playing;
+};
@@ -5,8 +5,13 @@
 #include <array>
 #include <vector>
 #include <memory>
-#include <functional>
 #include "ai_player.h"
+#include "frame_stats.h"
+#include "game_core.h"
+#include "gdi_renderer.h"
+#include "scene_model.h"
+#include "scene_painter.h"
+#include "ui_layout.h"
 
 class XOGame {
 public:
@@ -16,79 +21,67 @@ public:
     int Run(int nCmdShow);
     
 private:
-    // Game states
-    enum class GameScreen { Welcome, Game, GameOver };
-    enum class CellState { Empty, X, O };
-    enum class GameState { Playing, XWon, OWon, Draw };
-    enum class PlayerType { Human, AI };
-    enum class AIDifficulty { Easy, Normal, Hard };
-    
     // Window procedure
     static LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
     LRESULT HandleMessage(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
     
-    // Drawing functions
+    // Drawing functions; the screens themselves are laid out and drawn by ScenePainter
     void OnPaint(HWND hwnd);
-    void DrawWelcomeScreen(HDC hdc);
-    void DrawGameScreen(HDC hdc);
-    void DrawGameOverScreen(HDC hdc);
-    void DrawButton(HDC hdc, const std::wstring& text, RECT rect, bool isHovered, bool isActive = false);
-    void DrawBoard(HDC hdc);
-    void DrawCell(HDC hdc, int row, int col);
+    SceneState BuildScene() const;
+    void Repaint();     // Invalidates whatever changed since the last call
     
     // Input handling
     void OnMouseMove(int x, int y);
     void OnMouseClick(int x, int y);
+    void OnButton(UiAction action);
     
     // Game logic
     void StartGame(PlayerType xPlayerType, PlayerType oPlayerType);
     void ResetGame();
-    void CheckGameStatus();
-    void SwitchPlayer();
+    void AfterMove(UINT aiDelay);
     void UpdateStatusText();
     void MakeAIMove();
+    void ApplyAIMove(int row, int col);
+    void CancelAIMove();
+    
+    // Posted by the AI search thread: wParam is the request id, lParam the cell (row * GRID_SIZE + col, or -1)
+    static constexpr UINT WM_AI_MOVE = WM_APP + 1;
     
     // UI constants
-    static constexpr int GRID_SIZE = 3;
-    static constexpr int CELL_SIZE = 120;    // Increased from 100
-    static constexpr int WINDOW_WIDTH = 500;  // Fixed window width
-    static constexpr int WINDOW_HEIGHT = 600; // Fixed window height
-    static constexpr int BUTTON_HEIGHT = 45;  // Increased from 40
-    static constexpr int BUTTON_WIDTH = 180;  // Increased from 150
-    static constexpr int BUTTON_PADDING = 15; // Increased from 10
+    static constexpr int GRID_SIZE = GameCore::GRID_SIZE;
+    static constexpr int WINDOW_WIDTH = UiLayout::WINDOW_WIDTH;
+    static constexpr int WINDOW_HEIGHT = UiLayout::WINDOW_HEIGHT;
     
-    // UI Resources
+    // UI Resources - the renderer owns the back buffer, fonts, brushes and pens
     HINSTANCE m_hInstance;
     HWND m_hwnd;
-    HFONT m_titleFont;
-    HFONT m_buttonFont;
-    HFONT m_gameFont;
-    HFONT m_statusFont;
-    HBRUSH m_backgroundBrush;
-    HBRUSH m_cellBrush;
-    HBRUSH m_hoverBrush;
-    HBRUSH m_buttonBrush;
-    HBRUSH m_buttonHoverBrush;
-    HBRUSH m_buttonActiveBrush;
-    HBRUSH m_buttonFrameBrush;
-    HPEN m_gridPen;
+    GdiRenderer m_renderer;
     
     // UI State - keep in the same order as initialized in constructor
     GameScreen m_currentScreen;
     int m_hoveredButton;
     int m_hoverRow;
     int m_hoverCol;
-    std::vector<std::pair<RECT, std::function<void()>>> m_buttons;
+    UiLayout m_layout;                  // Widgets of the current screen, rebuilt when it changes
     
-    // Game State
-    GameState m_gameState;
-    CellState m_currentPlayer;
+    // Game State - the menu's player selection is handed to m_game when a game starts
+    GameCore m_game;
     std::wstring m_statusText;
     PlayerType m_xPlayerType;
     PlayerType m_oPlayerType;
     AIDifficulty m_aiDifficulty;
-    std::array<std::array<CellState, GRID_SIZE>, GRID_SIZE> m_board;
     
     // AI
     std::unique_ptr<AIPlayer> m_aiPlayer;
+    WPARAM m_aiRequest;   // Id of the outstanding AI search; results for older ids are ignored
+    
+    // Repainting - what the window shows, and a region reused to read WM_PAINT's update area
+    SceneModel m_sceneModel;
+    HRGN m_updateRegion;
+    
+    // Instrumentation - F3 shows the frame-time overlay, F4 saves a trace to TRACE_FILE
+    static constexpr const char* TRACE_FILE = "xo_trace.json";
+    FrameStats m_stats;
+    bool m_showStats;
+    FrameStats::Clock::time_point m_aiStart;   // When the outstanding AI search was requested
 }; 
\ No newline at end of file